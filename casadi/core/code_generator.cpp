@@ -47,6 +47,7 @@ namespace casadi {
     this->with_import = false;
     this->include_math = true;
     avoid_stack_ = false;
+    this->unroll_limit = 0;
     indent_ = 2;
 
     // Read options
@@ -80,11 +81,16 @@ namespace casadi {
         casadi_assert_dev(indent_>=0);
       } else if (e.first=="avoid_stack") {
         avoid_stack_ = e.second;
+      } else if (e.first=="unroll_limit") {
+        this->unroll_limit = e.second;
       } else {
         casadi_error("Unrecongnized option: " + str(e.first));
       }
     }
 
+    // Without the stack, scalar work vector elements must also live in w
+    if (avoid_stack_) this->codegen_scalars = true;
+
     // Start at new line with no indentation
     newline_ = true;
     current_indent_ = 0;
@@ -948,6 +954,21 @@ namespace casadi {
 
   string CodeGenerator::bilin(const string& A, const Sparsity& sp_A,
                                    const string& x, const string& y) {
+    // Straight-line code
+    if (unroll(sp_A.nnz())) {
+      if (sp_A.nnz()==0) return "0";
+      const casadi_int *colind = sp_A.colind(), *row = sp_A.row();
+      stringstream s;
+      s << "(";
+      for (casadi_int cc=0; cc<sp_A.size2(); ++cc) {
+        for (casadi_int el=colind[cc]; el<colind[cc+1]; ++el) {
+          if (el>0) s << "+";
+          s << elem(x, row[el]) << "*" << elem(A, el) << "*" << elem(y, cc);
+        }
+      }
+      s << ")";
+      return s.str();
+    }
     add_auxiliary(AUX_BILIN);
     stringstream s;
     s << "casadi_bilin(" << A << ", " << sparsity(sp_A) << ", " << x << ", " << y << ")";
@@ -957,6 +978,18 @@ namespace casadi {
   string CodeGenerator::rank1(const string& A, const Sparsity& sp_A,
                                    const string& alpha, const string& x,
                                    const string& y) {
+    // Straight-line code
+    if (unroll(sp_A.nnz())) {
+      const casadi_int *colind = sp_A.colind(), *row = sp_A.row();
+      stringstream s;
+      for (casadi_int cc=0; cc<sp_A.size2(); ++cc) {
+        for (casadi_int el=colind[cc]; el<colind[cc+1]; ++el) {
+          s << elem(A, el) << " += " << alpha << "*" << elem(x, row[el])
+            << "*" << elem(y, cc) << ";\n";
+        }
+      }
+      return s.str();
+    }
     add_auxiliary(AUX_RANK1);
     stringstream s;
     s << "casadi_rank1(" << A << ", " << sparsity(sp_A) << ", "
@@ -1016,6 +1049,23 @@ namespace casadi {
     // If sparsity match, simple copy
     if (sp_arg==sp_res) return copy(arg, sp_arg.nnz(), res);
 
+    // Straight-line code
+    if (unroll(sp_res.nnz())) {
+      const casadi_int *colind_arg = sp_arg.colind(), *row_arg = sp_arg.row();
+      const casadi_int *colind_res = sp_res.colind(), *row_res = sp_res.row();
+      vector<casadi_int> nz(sp_res.size1(), -1);
+      stringstream s;
+      for (casadi_int cc=0; cc<sp_res.size2(); ++cc) {
+        for (casadi_int el=colind_arg[cc]; el<colind_arg[cc+1]; ++el) nz[row_arg[el]] = el;
+        for (casadi_int el=colind_res[cc]; el<colind_res[cc+1]; ++el) {
+          casadi_int k = nz[row_res[el]];
+          s << elem(res, el) << " = " << (k<0 ? "0" : elem(arg, k)) << ";\n";
+        }
+        for (casadi_int el=colind_arg[cc]; el<colind_arg[cc+1]; ++el) nz[row_arg[el]] = -1;
+      }
+      return s.str();
+    }
+
     // Create call
     add_auxiliary(AUX_PROJECT);
     stringstream s;
@@ -1070,6 +1120,18 @@ namespace casadi {
 
   string CodeGenerator::mv(const string& x, const Sparsity& sp_x,
                                 const string& y, const string& z, bool tr) {
+    // Straight-line code, unless some argument is null
+    if (unroll(sp_x.nnz()) && x!="0" && y!="0" && z!="0") {
+      const casadi_int *colind = sp_x.colind(), *row = sp_x.row();
+      stringstream s;
+      for (casadi_int i=0; i<sp_x.size2(); ++i) {
+        for (casadi_int el=colind[i]; el<colind[i+1]; ++el) {
+          s << elem(z, tr ? i : row[el]) << " += " << elem(x, el) << "*"
+            << elem(y, tr ? row[el] : i) << ";\n";
+        }
+      }
+      return s.str();
+    }
     add_auxiliary(AUX_MV);
     return "casadi_mv(" + x + ", " + sparsity(sp_x) + ", " + y + ", "
            + z + ", " +  (tr ? "1" : "0") + ");";
@@ -1086,6 +1148,58 @@ namespace casadi {
                                     const string& y, const Sparsity& sp_y,
                                     const string& z, const Sparsity& sp_z,
                                     const string& w, bool tr) {
+    if (unroll_limit>0) {
+      // Collect the nonzero products contributing to each nonzero of z
+      const casadi_int *colind_x = sp_x.colind(), *row_x = sp_x.row();
+      const casadi_int *colind_y = sp_y.colind(), *row_y = sp_y.row();
+      const casadi_int *colind_z = sp_z.colind(), *row_z = sp_z.row();
+      vector<vector<pair<casadi_int, casadi_int> > > terms(sp_z.nnz());
+      casadi_int n_op = 0;
+      vector<casadi_int> nz(tr ? sp_y.size1() : sp_z.size1(), -1);
+      for (casadi_int cc=0; cc<sp_z.size2() && n_op<=unroll_limit; ++cc) {
+        if (tr) {
+          // z(:, cc) += x' * y(:, cc)
+          for (casadi_int k=colind_y[cc]; k<colind_y[cc+1]; ++k) nz[row_y[k]] = k;
+          for (casadi_int kz=colind_z[cc]; kz<colind_z[cc+1]; ++kz) {
+            casadi_int rr = row_z[kz];
+            for (casadi_int kx=colind_x[rr]; kx<colind_x[rr+1]; ++kx) {
+              casadi_int ky = nz[row_x[kx]];
+              if (ky<0) continue;
+              terms[kz].push_back(make_pair(kx, ky));
+              n_op++;
+            }
+          }
+          for (casadi_int k=colind_y[cc]; k<colind_y[cc+1]; ++k) nz[row_y[k]] = -1;
+        } else {
+          // z(:, cc) += x * y(:, cc)
+          for (casadi_int k=colind_z[cc]; k<colind_z[cc+1]; ++k) nz[row_z[k]] = k;
+          for (casadi_int ky=colind_y[cc]; ky<colind_y[cc+1]; ++ky) {
+            casadi_int rr = row_y[ky];
+            for (casadi_int kx=colind_x[rr]; kx<colind_x[rr+1]; ++kx) {
+              casadi_int kz = nz[row_x[kx]];
+              if (kz<0) continue;
+              terms[kz].push_back(make_pair(kx, ky));
+              n_op++;
+            }
+          }
+          for (casadi_int k=colind_z[cc]; k<colind_z[cc+1]; ++k) nz[row_z[k]] = -1;
+        }
+      }
+      // Straight-line code
+      if (unroll(n_op)) {
+        stringstream s;
+        for (casadi_int kz=0; kz<terms.size(); ++kz) {
+          if (terms[kz].empty()) continue;
+          s << elem(z, kz) << " +=";
+          for (casadi_int i=0; i<terms[kz].size(); ++i) {
+            s << (i==0 ? " " : "+") << elem(x, terms[kz][i].first)
+              << "*" << elem(y, terms[kz][i].second);
+          }
+          s << ";\n";
+        }
+        return s.str();
+      }
+    }
     add_auxiliary(AUX_MTIMES);
     return "casadi_mtimes(" + x + ", " + sparsity(sp_x) + ", " + y + ", " + sparsity(sp_y) + ", "
       + z + ", " + sparsity(sp_z) + ", " + w + ", " +  (tr ? "1" : "0") + ");";
@@ -1338,4 +1452,105 @@ namespace casadi {
            + lt + ", " + d + ", " + p + ", " + w + ");";
   }
 
+  std::string CodeGenerator::
+  ldl(const Sparsity& sp_a, const std::string& a,
+      const Sparsity& sp_lt, const std::string& lt, const std::string& d,
+      const std::vector<casadi_int>& p, const std::string& w) {
+    casadi_int n = sp_lt.size2();
+    const casadi_int *lt_colind = sp_lt.colind(), *lt_row = sp_lt.row();
+    const casadi_int *a_colind = sp_a.colind(), *a_row = sp_a.row();
+
+    // Count the number of operations
+    casadi_int n_op = 0;
+    for (casadi_int k=0; k<sp_lt.nnz(); ++k) {
+      casadi_int r = lt_row[k];
+      n_op += 1 + lt_colind[r+1] - lt_colind[r];
+    }
+    if (!unroll(n_op)) {
+      return ldl(sparsity(sp_a), a, sparsity(sp_lt), lt, d, constant(p), w);
+    }
+
+    // Straight-line code, following casadi_ldl
+    stringstream s;
+    vector<casadi_int> nz(n, -1);
+    // Sparse copy of A to L and D
+    for (casadi_int c=0; c<n; ++c) {
+      casadi_int c1 = p[c];
+      for (casadi_int k=a_colind[c1]; k<a_colind[c1+1]; ++k) nz[a_row[k]] = k;
+      for (casadi_int k=lt_colind[c]; k<lt_colind[c+1]; ++k) {
+        casadi_int ka = nz[p[lt_row[k]]];
+        s << elem(lt, k) << " = " << (ka<0 ? "0" : elem(a, ka)) << ";\n";
+      }
+      casadi_int ka = nz[p[c]];
+      s << elem(d, c) << " = " << (ka<0 ? "0" : elem(a, ka)) << ";\n";
+      for (casadi_int k=a_colind[c1]; k<a_colind[c1+1]; ++k) nz[a_row[k]] = -1;
+    }
+    // Loop over columns of L, w only needs to hold entries of the current column
+    for (casadi_int c=0; c<n; ++c) {
+      for (casadi_int k=lt_colind[c]; k<lt_colind[c+1]; ++k) {
+        casadi_int r = lt_row[k];
+        for (casadi_int k2=lt_colind[r]; k2<lt_colind[r+1]; ++k2) {
+          if (nz[lt_row[k2]]<0) continue;
+          s << elem(lt, k) << " -= " << elem(lt, k2) << "*" << elem(w, lt_row[k2]) << ";\n";
+        }
+        s << elem(w, r) << " = " << elem(lt, k) << ";\n"
+          << elem(lt, k) << " /= " << elem(d, r) << ";\n"
+          << elem(d, c) << " -= " << elem(w, r) << "*" << elem(lt, k) << ";\n";
+        nz[r] = k;
+      }
+      for (casadi_int k=lt_colind[c]; k<lt_colind[c+1]; ++k) nz[lt_row[k]] = -1;
+    }
+    return s.str();
+  }
+
+  std::string CodeGenerator::
+  ldl_solve(const std::string& x, casadi_int nrhs,
+            const Sparsity& sp_lt, const std::string& lt, const std::string& d,
+            const std::vector<casadi_int>& p, const std::string& w) {
+    casadi_int n = sp_lt.size2();
+    const casadi_int *colind = sp_lt.colind(), *row = sp_lt.row();
+    if (!unroll(nrhs*(2*sp_lt.nnz() + 3*n))) {
+      return ldl_solve(x, nrhs, sparsity(sp_lt), lt, d, constant(p), w);
+    }
+
+    // Straight-line code, following casadi_ldl_solve
+    stringstream s;
+    for (casadi_int k=0; k<nrhs; ++k) {
+      // Multiply by P
+      for (casadi_int i=0; i<n; ++i) s << elem(w, i) << " = " << elem(x, k*n+p[i]) << ";\n";
+      // Solve for L
+      for (casadi_int c=0; c<n; ++c) {
+        for (casadi_int el=colind[c]; el<colind[c+1]; ++el) {
+          s << elem(w, c) << " -= " << elem(lt, el) << "*" << elem(w, row[el]) << ";\n";
+        }
+      }
+      // Divide by D
+      for (casadi_int i=0; i<n; ++i) s << elem(w, i) << " /= " << elem(d, i) << ";\n";
+      // Solve for L'
+      for (casadi_int c=n-1; c>=0; --c) {
+        for (casadi_int el=colind[c+1]-1; el>=colind[c]; --el) {
+          s << elem(w, row[el]) << " -= " << elem(lt, el) << "*" << elem(w, c) << ";\n";
+        }
+      }
+      // Multiply by P'
+      for (casadi_int i=0; i<n; ++i) s << elem(x, k*n+p[i]) << " = " << elem(w, i) << ";\n";
+    }
+    return s.str();
+  }
+
+  std::string CodeGenerator::elem(const std::string& x, casadi_int k) {
+    // Parenthesize unless x is a variable, possibly indexed, or already parenthesized
+    bool simple = x.front()=='(' && x.back()==')';
+    if (!simple) {
+      simple = true;
+      for (char c : x) {
+        if (!(isalnum(c) || c=='_' || c=='[' || c==']')) {
+          simple = false;
+          break;
+        }
+      }
+    }
+    return (simple ? x : "(" + x + ")") + "[" + str(k) + "]";
+  }
+
 } // namespace casadi
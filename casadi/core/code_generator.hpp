@@ -228,6 +228,21 @@ namespace casadi {
                          const std::string& d, const std::string& p,
                          const std::string& w);
 
+    /** \brief LDL factorization, unrolled if small enough */
+    std::string ldl(const Sparsity& sp_a, const std::string& a,
+                    const Sparsity& sp_lt, const std::string& lt,
+                    const std::string& d, const std::vector<casadi_int>& p,
+                    const std::string& w);
+
+    /** \brief LDL solve, unrolled if small enough */
+    std::string ldl_solve(const std::string& x, casadi_int nrhs,
+                          const Sparsity& sp_lt, const std::string& lt,
+                          const std::string& d, const std::vector<casadi_int>& p,
+                          const std::string& w);
+
+    /** \brief Unroll a sparse kernel with a given number of operations? */
+    bool unroll(casadi_int n_op) const { return unroll_limit>0 && n_op<=unroll_limit;}
+
     /** \brief Declare a function */
     std::string declare(std::string s);
 
@@ -361,6 +376,9 @@ namespace casadi {
     // Generate import symbol macros
     void generate_import_symbol(std::ostream &s) const;
 
+    // Element k of an array expression
+    static std::string elem(const std::string& x, casadi_int k);
+
     //  private:
   public:
     /// \cond INTERNAL
@@ -398,6 +416,12 @@ namespace casadi {
     // Do we want to be lean on stack usage?
     bool avoid_stack_;
 
+    /** \brief Unroll sparse kernels
+     * Sparse kernels with at most this many operations are generated as
+     * straight-line code with the sparsity pattern hard-coded (0: never)
+     */
+    casadi_int unroll_limit;
+
     /** \brief Codegen scalar
      * Use the work vector for storing work vector elements of length 1
      * (typically scalar) instead of using local variables
@@ -35,6 +35,14 @@
 #include <unordered_map>
 #define CACHING_MAP std::unordered_map
 
+#ifdef CASADI_WITH_THREAD
+#ifdef CASADI_WITH_THREAD_MINGW
+#include <mingw.mutex.h>
+#else // CASADI_WITH_THREAD_MINGW
+#include <mutex>
+#endif // CASADI_WITH_THREAD_MINGW
+#endif //CASADI_WITH_THREAD
+
 namespace casadi {
 
 /** \brief Represents a constant SX
@@ -91,29 +99,38 @@ class RealtypeSX : public ConstantSX {
 
     /// Destructor
     ~RealtypeSX() override {
-      size_t num_erased = cached_constants_.erase(value);
-      assert(num_erased==1);
-      (void)num_erased;
+#ifdef CASADI_WITH_THREAD
+      std::lock_guard<std::mutex> lock(cache_mutex());
+#endif //CASADI_WITH_THREAD
+      // The entry may already have been replaced by a new node
+      CACHING_MAP<double, RealtypeSX*>::iterator it = cached_constants_.find(value);
+      if (it!=cached_constants_.end() && it->second==this) cached_constants_.erase(it);
     }
 
-    /// Static creator function (use instead of constructor)
+    /// Static creator function (use instead of constructor), increases the reference count
     inline static RealtypeSX* create(double value) {
+#ifdef CASADI_WITH_THREAD
+      std::lock_guard<std::mutex> lock(cache_mutex());
+#endif //CASADI_WITH_THREAD
       // Try to find the constant
       CACHING_MAP<double, RealtypeSX*>::iterator it = cached_constants_.find(value);
 
-      // If not found, add it,
-      if (it==cached_constants_.end()) {
-        // Allocate a new object
-        RealtypeSX* n = new RealtypeSX(value);
+      // Return the object, unless it is already being deleted
+      if (it!=cached_constants_.end() && it->second->count_up_if_alive()) return it->second;
 
-        // Add to hash_table
-        cached_constants_.insert(it, std::make_pair(value, n));
+      // Allocate a new object
+      RealtypeSX* n = new RealtypeSX(value);
+      n->count++;
 
-        // Return it to caller
-        return n;
-      } else { // Else, returned the object
-        return it->second;
+      // Add to hash_table
+      if (it==cached_constants_.end()) {
+        cached_constants_.insert(it, std::make_pair(value, n));
+      } else {
+        it->second = n;
       }
+
+      // Return it to caller
+      return n;
     }
 
     ///@{
@@ -129,6 +146,14 @@ class RealtypeSX : public ConstantSX {
      * (storage is allocated for it in sx_element.cpp) */
     static CACHING_MAP<double, RealtypeSX*> cached_constants_;
 
+#ifdef CASADI_WITH_THREAD
+    /** \brief Protects cached_constants_, never destroyed */
+    static std::mutex& cache_mutex() {
+      static std::mutex* m = new std::mutex();
+      return *m;
+    }
+#endif //CASADI_WITH_THREAD
+
     /** \brief  Data members */
     double value;
 };
@@ -150,29 +175,38 @@ class IntegerSX : public ConstantSX {
 
     /// Destructor
     ~IntegerSX() override {
-      size_t num_erased = cached_constants_.erase(value);
-      assert(num_erased==1);
-      (void)num_erased;
+#ifdef CASADI_WITH_THREAD
+      std::lock_guard<std::mutex> lock(cache_mutex());
+#endif //CASADI_WITH_THREAD
+      // The entry may already have been replaced by a new node
+      CACHING_MAP<casadi_int, IntegerSX*>::iterator it = cached_constants_.find(value);
+      if (it!=cached_constants_.end() && it->second==this) cached_constants_.erase(it);
     }
 
-    /// Static creator function (use instead of constructor)
+    /// Static creator function (use instead of constructor), increases the reference count
     inline static IntegerSX* create(casadi_int value) {
+#ifdef CASADI_WITH_THREAD
+      std::lock_guard<std::mutex> lock(cache_mutex());
+#endif //CASADI_WITH_THREAD
       // Try to find the constant
       CACHING_MAP<casadi_int, IntegerSX*>::iterator it = cached_constants_.find(value);
 
-      // If not found, add it,
-      if (it==cached_constants_.end()) {
-        // Allocate a new object
-        IntegerSX* n = new IntegerSX(value);
+      // Return the object, unless it is already being deleted
+      if (it!=cached_constants_.end() && it->second->count_up_if_alive()) return it->second;
 
-        // Add to hash_table
-        cached_constants_.insert(it, std::make_pair(value, n));
+      // Allocate a new object
+      IntegerSX* n = new IntegerSX(value);
+      n->count++;
 
-        // Return it to caller
-        return n;
-      } else { // Else, returned the object
-        return it->second;
+      // Add to hash_table
+      if (it==cached_constants_.end()) {
+        cached_constants_.insert(it, std::make_pair(value, n));
+      } else {
+        it->second = n;
       }
+
+      // Return it to caller
+      return n;
     }
 
     ///@{
@@ -190,6 +224,14 @@ class IntegerSX : public ConstantSX {
      * (storage is allocated for it in sx_element.cpp) */
     static CACHING_MAP<casadi_int, IntegerSX*> cached_constants_;
 
+#ifdef CASADI_WITH_THREAD
+    /** \brief Protects cached_constants_, never destroyed */
+    static std::mutex& cache_mutex() {
+      static std::mutex* m = new std::mutex();
+      return *m;
+    }
+#endif //CASADI_WITH_THREAD
+
     /** \brief  Data members */
     int value;
 };
@@ -36,7 +36,7 @@
 #include "exception.hpp"
 #include "code_generator.hpp"
 #include "calculus.hpp"
-#include "xml_file.hpp"
+#include "xml_reader.hpp"
 #include "external.hpp"
 
 using namespace std;
@@ -48,283 +48,247 @@ namespace casadi {
 
   void DaeBuilder::parse_fmi(const std::string& filename) {
 
-    // Load
-    XmlFile xml_file("tinyxml");
-    XmlNode document = xml_file.parse(filename);
+    // Stream the document, reading one variable or equation at a time
+    XmlReader xml(filename);
+    string section;
+    while (xml.next()) {
+      if (!xml.is_start()) continue;
 
-    // **** Add model variables ****
-    {
-      // Get a reference to the ModelVariables node
-      const XmlNode& modvars = document[0]["ModelVariables"];
-
-      // Add variables
-      for (casadi_int i=0; i<modvars.size(); ++i) {
-
-        // Get a reference to the variable
-        const XmlNode& vnode = modvars[i];
-
-        // Get the attributes
-        string name        = vnode.getAttribute("name");
-        casadi_int valueReference;
-        vnode.readAttribute("valueReference", valueReference);
-        string variability = vnode.getAttribute("variability");
-        string causality   = vnode.getAttribute("causality");
-        string alias       = vnode.getAttribute("alias");
-
-        // Skip to the next variable if its an alias
-        if (alias.compare("alias") == 0 || alias.compare("negatedAlias") == 0)
-          continue;
-
-        // Get the name
-        const XmlNode& nn = vnode["QualifiedName"];
-        string qn = qualified_name(nn);
-
-        // Add variable, if not already added
-        if (varmap_.find(qn)==varmap_.end()) {
-
-          // Create variable
-          Variable var(name);
-
-          // Value reference
-          var.valueReference = valueReference;
-
-          // Variability
-          if (variability.compare("constant")==0)
-            var.variability = CONSTANT;
-          else if (variability.compare("parameter")==0)
-            var.variability = PARAMETER;
-          else if (variability.compare("discrete")==0)
-            var.variability = DISCRETE;
-          else if (variability.compare("continuous")==0)
-            var.variability = CONTINUOUS;
-          else
-            throw CasadiException("Unknown variability");
-
-          // Causality
-          if (causality.compare("input")==0)
-            var.causality = INPUT;
-          else if (causality.compare("output")==0)
-            var.causality = OUTPUT;
-          else if (causality.compare("internal")==0)
-            var.causality = INTERNAL;
-          else
-            throw CasadiException("Unknown causality");
-
-          // Alias
-          if (alias.compare("noAlias")==0)
-            var.alias = NO_ALIAS;
-          else if (alias.compare("alias")==0)
-            var.alias = ALIAS;
-          else if (alias.compare("negatedAlias")==0)
-            var.alias = NEGATED_ALIAS;
-          else
-            throw CasadiException("Unknown alias");
-
-          // Other properties
-          if (vnode.hasChild("Real")) {
-            const XmlNode& props = vnode["Real"];
-            props.readAttribute("unit", var.unit, false);
-            props.readAttribute("displayUnit", var.display_unit, false);
-            props.readAttribute("min", var.min, false);
-            props.readAttribute("max", var.max, false);
-            props.readAttribute("initialGuess", var.guess, false);
-            props.readAttribute("start", var.start, false);
-            props.readAttribute("nominal", var.nominal, false);
-            props.readAttribute("free", var.free, false);
-          }
-
-          // Variable category
-          if (vnode.hasChild("VariableCategory")) {
-            string cat = vnode["VariableCategory"].getText();
-            if (cat.compare("derivative")==0)
-              var.category = CAT_DERIVATIVE;
-            else if (cat.compare("state")==0)
-              var.category = CAT_STATE;
-            else if (cat.compare("dependentConstant")==0)
-              var.category = CAT_DEPENDENT_CONSTANT;
-            else if (cat.compare("independentConstant")==0)
-              var.category = CAT_INDEPENDENT_CONSTANT;
-            else if (cat.compare("dependentParameter")==0)
-              var.category = CAT_DEPENDENT_PARAMETER;
-            else if (cat.compare("independentParameter")==0)
-              var.category = CAT_INDEPENDENT_PARAMETER;
-            else if (cat.compare("algebraic")==0)
-              var.category = CAT_ALGEBRAIC;
-            else
-              throw CasadiException("Unknown variable category: " + cat);
-          }
-
-          // Add to list of variables
-          add_variable(qn, var);
-
-          // Sort expression
-          switch (var.category) {
-          case CAT_DERIVATIVE:
-            // Skip - meta information about time derivatives is
-            //        kept together with its parent variable
-            break;
-          case CAT_STATE:
-            this->s.push_back(var.v);
-            this->sdot.push_back(var.d);
-            break;
-          case CAT_DEPENDENT_CONSTANT:
-            // Skip
-            break;
-          case CAT_INDEPENDENT_CONSTANT:
-            // Skip
-            break;
-          case CAT_DEPENDENT_PARAMETER:
-            // Skip
-            break;
-          case CAT_INDEPENDENT_PARAMETER:
-            if (var.free) {
-              this->p.push_back(var.v);
-            } else {
-              // Skip
-            }
-            break;
-          case CAT_ALGEBRAIC:
-            if (var.causality == INTERNAL) {
-              this->s.push_back(var.v);
-              this->sdot.push_back(var.d);
-            } else if (var.causality == INPUT) {
-              this->u.push_back(var.v);
-            }
-            break;
-          default:
-            casadi_error("Unknown category");
-          }
-        }
+      // Sections are the children of the root element
+      if (xml.depth()==1) {
+        section = xml.node().name();
+        continue;
       }
-    }
-
-    // **** Add binding equations ****
-    {
-      // Get a reference to the BindingEquations node
-      const XmlNode& bindeqs = document[0]["equ:BindingEquations"];
 
-      for (casadi_int i=0; i<bindeqs.size(); ++i) {
-        const XmlNode& beq = bindeqs[i];
-
-        // Get the variable and binding expression
+      // Entries of a section
+      if (xml.depth()!=2) continue;
+      if (section=="ModelVariables") {
+        // Add model variable
+        import_variable(xml.read_node());
+      } else if (section=="equ:BindingEquations") {
+        // Add binding equation
+        XmlNode beq = xml.read_node();
         Variable& var = read_variable(beq[0]);
         MX bexpr = read_expr(beq[1][0]);
         this->d.push_back(var.v);
         this->ddef.push_back(bexpr);
+      } else if (section=="equ:DynamicEquations") {
+        // Add differential equation
+        XmlNode dnode = xml.read_node();
+        this->dae.push_back(read_expr(dnode[0]));
+      } else if (section=="equ:InitialEquations") {
+        // Add initial equations
+        XmlNode inode = xml.read_node();
+        for (casadi_int i=0; i<inode.size(); ++i) {
+          this->init.push_back(read_expr(inode[i]));
+        }
+      } else if (section=="opt:Optimization") {
+        // Add optimization problem component
+        import_optimization(xml.read_node());
       }
     }
 
-    // **** Add dynamic equations ****
-    {
-      // Get a reference to the DynamicEquations node
-      const XmlNode& dyneqs = document[0]["equ:DynamicEquations"];
-
-      // Add equations
-      for (casadi_int i=0; i<dyneqs.size(); ++i) {
-
-        // Get a reference to the variable
-        const XmlNode& dnode = dyneqs[i];
-
-        // Add the differential equation
-        MX de_new = read_expr(dnode[0]);
-        this->dae.push_back(de_new);
-      }
+    // Make sure that the dimensions are consistent at this point
+    if (this->s.size()!=this->dae.size()) {
+      casadi_warning("The number of differential-algebraic equations does not match "
+                     "the number of implicitly defined states.");
     }
+    if (this->z.size()!=this->alg.size()) {
+      casadi_warning("The number of algebraic equations (equations not involving "
+                    "differentiated variables) does not match the number of "
+                    "algebraic variables.");
+    }
+  }
 
-    // **** Add initial equations ****
-    {
-      // Get a reference to the DynamicEquations node
-      const XmlNode& initeqs = document[0]["equ:InitialEquations"];
-
-      // Add equations
-      for (casadi_int i=0; i<initeqs.size(); ++i) {
+  void DaeBuilder::import_variable(const XmlNode& vnode) {
+    // Get the attributes
+    string name        = vnode.getAttribute("name");
+    casadi_int valueReference;
+    vnode.readAttribute("valueReference", valueReference);
+    string variability = vnode.getAttribute("variability");
+    string causality   = vnode.getAttribute("causality");
+    string alias       = vnode.getAttribute("alias");
+
+    // Skip the variable if its an alias
+    if (alias.compare("alias") == 0 || alias.compare("negatedAlias") == 0)
+      return;
+
+    // Get the name
+    const XmlNode& nn = vnode["QualifiedName"];
+    string qn = qualified_name(nn);
+
+    // Add variable, if not already added
+    if (varmap_.find(qn)==varmap_.end()) {
+
+      // Create variable
+      Variable var(name);
+
+      // Value reference
+      var.valueReference = valueReference;
+
+      // Variability
+      if (variability.compare("constant")==0)
+        var.variability = CONSTANT;
+      else if (variability.compare("parameter")==0)
+        var.variability = PARAMETER;
+      else if (variability.compare("discrete")==0)
+        var.variability = DISCRETE;
+      else if (variability.compare("continuous")==0)
+        var.variability = CONTINUOUS;
+      else
+        throw CasadiException("Unknown variability");
+
+      // Causality
+      if (causality.compare("input")==0)
+        var.causality = INPUT;
+      else if (causality.compare("output")==0)
+        var.causality = OUTPUT;
+      else if (causality.compare("internal")==0)
+        var.causality = INTERNAL;
+      else
+        throw CasadiException("Unknown causality");
+
+      // Alias
+      if (alias.compare("noAlias")==0)
+        var.alias = NO_ALIAS;
+      else if (alias.compare("alias")==0)
+        var.alias = ALIAS;
+      else if (alias.compare("negatedAlias")==0)
+        var.alias = NEGATED_ALIAS;
+      else
+        throw CasadiException("Unknown alias");
+
+      // Other properties
+      if (vnode.hasChild("Real")) {
+        const XmlNode& props = vnode["Real"];
+        props.readAttribute("unit", var.unit, false);
+        props.readAttribute("displayUnit", var.display_unit, false);
+        props.readAttribute("min", var.min, false);
+        props.readAttribute("max", var.max, false);
+        props.readAttribute("initialGuess", var.guess, false);
+        props.readAttribute("start", var.start, false);
+        props.readAttribute("nominal", var.nominal, false);
+        props.readAttribute("free", var.free, false);
+      }
 
-        // Get a reference to the node
-        const XmlNode& inode = initeqs[i];
+      // Variable category
+      if (vnode.hasChild("VariableCategory")) {
+        string cat = vnode["VariableCategory"].getText();
+        if (cat.compare("derivative")==0)
+          var.category = CAT_DERIVATIVE;
+        else if (cat.compare("state")==0)
+          var.category = CAT_STATE;
+        else if (cat.compare("dependentConstant")==0)
+          var.category = CAT_DEPENDENT_CONSTANT;
+        else if (cat.compare("independentConstant")==0)
+          var.category = CAT_INDEPENDENT_CONSTANT;
+        else if (cat.compare("dependentParameter")==0)
+          var.category = CAT_DEPENDENT_PARAMETER;
+        else if (cat.compare("independentParameter")==0)
+          var.category = CAT_INDEPENDENT_PARAMETER;
+        else if (cat.compare("algebraic")==0)
+          var.category = CAT_ALGEBRAIC;
+        else
+          throw CasadiException("Unknown variable category: " + cat);
+      }
 
-        // Add the differential equations
-        for (casadi_int i=0; i<inode.size(); ++i) {
-          this->init.push_back(read_expr(inode[i]));
+      // Add to list of variables
+      add_variable(qn, var);
+
+      // Sort expression
+      switch (var.category) {
+      case CAT_DERIVATIVE:
+        // Skip - meta information about time derivatives is
+        //        kept together with its parent variable
+        break;
+      case CAT_STATE:
+        this->s.push_back(var.v);
+        this->sdot.push_back(var.d);
+        break;
+      case CAT_DEPENDENT_CONSTANT:
+        // Skip
+        break;
+      case CAT_INDEPENDENT_CONSTANT:
+        // Skip
+        break;
+      case CAT_DEPENDENT_PARAMETER:
+        // Skip
+        break;
+      case CAT_INDEPENDENT_PARAMETER:
+        if (var.free) {
+          this->p.push_back(var.v);
+        } else {
+          // Skip
         }
+        break;
+      case CAT_ALGEBRAIC:
+        if (var.causality == INTERNAL) {
+          this->s.push_back(var.v);
+          this->sdot.push_back(var.d);
+        } else if (var.causality == INPUT) {
+          this->u.push_back(var.v);
+        }
+        break;
+      default:
+        casadi_error("Unknown category");
       }
     }
+  }
 
-    // **** Add optimization ****
-    if (document[0].hasChild("opt:Optimization")) {
-
-      // Get a reference to the DynamicEquations node
-      const XmlNode& opts = document[0]["opt:Optimization"];
-      for (casadi_int i=0; i<opts.size(); ++i) {
-
-        // Get a reference to the node
-        const XmlNode& onode = opts[i];
-
-        // Get the type
-        if (onode.checkName("opt:ObjectiveFunction")) { // mayer term
-          try {
-            // Add components
-            for (casadi_int i=0; i<onode.size(); ++i) {
-              const XmlNode& var = onode[i];
+  void DaeBuilder::import_optimization(const XmlNode& onode) {
+    // Get the type
+    if (onode.checkName("opt:ObjectiveFunction")) { // mayer term
+      try {
+        // Add components
+        for (casadi_int i=0; i<onode.size(); ++i) {
+          const XmlNode& var = onode[i];
 
-              // If string literal, ignore
-              if (var.checkName("exp:StringLiteral"))
-                continue;
+          // If string literal, ignore
+          if (var.checkName("exp:StringLiteral"))
+            continue;
 
-              // Read expression
-              MX v = read_expr(var);
+          // Read expression
+          MX v = read_expr(var);
 
-              // Treat as an output
-              add_y("mterm", v);
-            }
-          } catch(exception& ex) {
-            throw CasadiException(std::string("addObjectiveFunction failed: ") + ex.what());
-          }
-        } else if (onode.checkName("opt:IntegrandObjectiveFunction")) {
-          try {
-            for (casadi_int i=0; i<onode.size(); ++i) {
-              const XmlNode& var = onode[i];
+          // Treat as an output
+          add_y("mterm", v);
+        }
+      } catch(exception& ex) {
+        throw CasadiException(std::string("addObjectiveFunction failed: ") + ex.what());
+      }
+    } else if (onode.checkName("opt:IntegrandObjectiveFunction")) {
+      try {
+        for (casadi_int i=0; i<onode.size(); ++i) {
+          const XmlNode& var = onode[i];
 
-              // If string literal, ignore
-              if (var.checkName("exp:StringLiteral")) continue;
+          // If string literal, ignore
+          if (var.checkName("exp:StringLiteral")) continue;
 
-              // Read expression
-              MX v = read_expr(var);
+          // Read expression
+          MX v = read_expr(var);
 
-              // Treat as a quadrature state
-              add_q("lterm");
-              add_quad("lterm_rhs", v);
-            }
-          } catch(exception& ex) {
-            throw CasadiException(std::string("addIntegrandObjectiveFunction failed: ")
-                                  + ex.what());
-          }
-        } else if (onode.checkName("opt:IntervalStartTime")) {
-          // Ignore, treated above
-        } else if (onode.checkName("opt:IntervalFinalTime")) {
-          // Ignore, treated above
-        } else if (onode.checkName("opt:TimePoints")) {
-          // Ignore, treated above
-        } else if (onode.checkName("opt:PointConstraints")) {
-          casadi_warning("opt:PointConstraints not supported, ignored");
-        } else if (onode.checkName("opt:Constraints")) {
-          casadi_warning("opt:Constraints not supported, ignored");
-        } else if (onode.checkName("opt:PathConstraints")) {
-          casadi_warning("opt:PointConstraints not supported, ignored");
-        } else {
-          casadi_warning("DaeBuilder::addOptimization: Unknown node " + str(onode.name()));
+          // Treat as a quadrature state
+          add_q("lterm");
+          add_quad("lterm_rhs", v);
         }
+      } catch(exception& ex) {
+        throw CasadiException(std::string("addIntegrandObjectiveFunction failed: ")
+                              + ex.what());
       }
-    }
-
-    // Make sure that the dimensions are consistent at this point
-    if (this->s.size()!=this->dae.size()) {
-      casadi_warning("The number of differential-algebraic equations does not match "
-                     "the number of implicitly defined states.");
-    }
-    if (this->z.size()!=this->alg.size()) {
-      casadi_warning("The number of algebraic equations (equations not involving "
-                    "differentiated variables) does not match the number of "
-                    "algebraic variables.");
+    } else if (onode.checkName("opt:IntervalStartTime")) {
+      // Ignore, treated above
+    } else if (onode.checkName("opt:IntervalFinalTime")) {
+      // Ignore, treated above
+    } else if (onode.checkName("opt:TimePoints")) {
+      // Ignore, treated above
+    } else if (onode.checkName("opt:PointConstraints")) {
+      casadi_warning("opt:PointConstraints not supported, ignored");
+    } else if (onode.checkName("opt:Constraints")) {
+      casadi_warning("opt:Constraints not supported, ignored");
+    } else if (onode.checkName("opt:PathConstraints")) {
+      casadi_warning("opt:PointConstraints not supported, ignored");
+    } else {
+      casadi_warning("DaeBuilder::addOptimization: Unknown node " + str(onode.name()));
     }
   }
 
@@ -490,6 +490,12 @@ namespace casadi {
     /// Read a variable
     Variable& read_variable(const XmlNode& node);
 
+    /// Add a model variable from its description
+    void import_variable(const XmlNode& vnode);
+
+    /// Add a component of the optimization problem
+    void import_optimization(const XmlNode& onode);
+
     /// Get an attribute by expression
     typedef double (DaeBuilder::*getAtt)(const std::string& name, bool normalized) const;
     std::vector<double> attribute(getAtt f, const MX& var, bool normalized) const;
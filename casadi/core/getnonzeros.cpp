@@ -499,6 +499,11 @@ namespace casadi {
     return dep()->get_nzref(sp, nz_new);
   }
 
+  MX GetNonzeros::get_reshape(const Sparsity& sp) const {
+    // Reshape does not change the order of the nonzeros, merge into one operation
+    return dep()->get_nzref(sp, all());
+  }
+
   void GetNonzerosSlice::generate(CodeGenerator& g,
                                   const std::vector<casadi_int>& arg,
                                   const std::vector<casadi_int>& res) const {
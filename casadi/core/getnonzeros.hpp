@@ -75,6 +75,9 @@ namespace casadi {
 
     /// Get the nonzeros of matrix
     MX get_nzref(const Sparsity& sp, const std::vector<casadi_int>& nz) const override;
+
+    /// Reshape
+    MX get_reshape(const Sparsity& sp) const override;
   };
 
   class CASADI_EXPORT GetNonzerosVector : public GetNonzeros {
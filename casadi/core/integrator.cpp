@@ -153,6 +153,7 @@ namespace casadi {
 
     // Reset statistics
     for (auto&& s : m->fstats) s.second.reset();
+    for (auto&& s : m->n_cache_hit) s.second = 0;
     m->fstats.at(name_).tic();
 
     // Read inputs
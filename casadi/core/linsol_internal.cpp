@@ -103,7 +103,7 @@ namespace casadi {
   }
 
   void LinsolInternal::generate(CodeGenerator& g, const std::string& A, const std::string& x,
-                                casadi_int nrhs, bool tr) const {
+                                casadi_int nrhs, bool tr, const std::string& w) const {
     g << "#error " <<  class_name() << " does not support code generation\n";
   }
 
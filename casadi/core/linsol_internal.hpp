@@ -105,7 +105,10 @@ namespace casadi {
 
     /// Generate C code
     virtual void generate(CodeGenerator& g, const std::string& A, const std::string& x,
-                          casadi_int nrhs, bool tr) const;
+                          casadi_int nrhs, bool tr, const std::string& w) const;
+
+    /// Size of the work vector needed by the generated code
+    virtual size_t codegen_sz_w() const { return 0;}
 
     // Creator function for internal class
     typedef LinsolInternal* (*Creator)(const std::string& name, const Sparsity& sp);
@@ -3140,6 +3140,77 @@ namespace casadi {
     return r;
   }
 
+  /** \brief Replace symbolic primitives in a single pass over the graph
+
+      Each node is visited once and nodes whose dependencies are unaffected
+      are kept rather than recreated.
+  */
+  static void sx_rewrite(const vector<SXElem>& v, const vector<SXElem>& vdef,
+                         vector<SXElem>& ex) {
+    // Replacement of each node visited, indexed by the marker minus one
+    NodeMarker<SXNode> m;
+    vector<SXElem> rep = vdef;
+    vector<SXNode*> visited;
+    visited.reserve(v.size());
+    for (casadi_int k=0; k<v.size(); ++k) {
+      SXNode* n = v[k].get();
+      if (m.get(n)!=0) {
+        for (SXNode* t : visited) m.reset(t);
+        casadi_error("Cannot substitute " + str(v[k]) + ": appears more than once");
+      }
+      m.set(n, k+1);
+      visited.push_back(n);
+    }
+
+    // Nodes waiting for their dependencies to be rewritten
+    vector<SXNode*> stack;
+    for (SXElem& e : ex) {
+      stack.push_back(e.get());
+      while (!stack.empty()) {
+        SXNode* n = stack.back();
+        if (m.get(n)!=0) {
+          stack.pop_back();
+          continue;
+        }
+        // Rewrite the dependencies first
+        casadi_int ndeps = n->n_dep();
+        bool ready = true;
+        for (casadi_int i=0; i<ndeps; ++i) {
+          SXNode* d = n->dep(i).get();
+          if (m.get(d)==0) {
+            stack.push_back(d);
+            ready = false;
+          }
+        }
+        if (!ready) continue;
+        stack.pop_back();
+
+        // Keep the node if none of its dependencies changed
+        SXElem r;
+        if (ndeps==0) {
+          r = SXElem::create(n);
+        } else {
+          const SXElem& x = rep[m.get(n->dep(0).get())-1];
+          const SXElem& y = rep[m.get(n->dep(ndeps-1).get())-1];
+          if (x.get()==n->dep(0).get() && y.get()==n->dep(ndeps-1).get()) {
+            r = SXElem::create(n);
+          } else {
+            switch (n->op()) {
+              CASADI_MATH_FUN_BUILTIN(x, y, r)
+            }
+          }
+        }
+        rep.push_back(r);
+        m.set(n, rep.size());
+        visited.push_back(n);
+      }
+      e = rep[m.get(e.get())-1];
+    }
+
+    // Clear markers
+    for (SXNode* t : visited) m.reset(t);
+  }
+
   template<>
   SX SX::substitute(const SX& ex, const SX& v, const SX& vdef) {
     return substitute(vector<SX>{ex}, vector<SX>{v}, vector<SX>{vdef}).front();
@@ -3182,9 +3253,30 @@ namespace casadi {
     }
 
 
-    // Otherwise, evaluate symbolically
-    Function F("tmp", v, ex);
-    return F(vdef);
+    // Symbolic primitives and their replacements
+    vector<SXElem> v_nz, vdef_nz;
+    for (casadi_int k=0; k<v.size(); ++k) {
+      for (casadi_int i=0; i<v[k].nnz(); ++i) {
+        const SXElem& vi = v[k]->at(i);
+        casadi_assert(vi.is_symbolic(), "Cannot substitute " + str(vi) + ": not symbolic");
+        v_nz.push_back(vi);
+        vdef_nz.push_back(vdef[k]->at(i));
+      }
+    }
+
+    // Rewrite all expressions in one pass, sharing common subexpressions
+    vector<SXElem> nz;
+    for (const SX& e : ex) nz.insert(nz.end(), e->begin(), e->end());
+    sx_rewrite(v_nz, vdef_nz, nz);
+
+    // Collect the results
+    vector<SX> ret(ex.size());
+    vector<SXElem>::const_iterator it = nz.begin();
+    for (casadi_int i=0; i<ex.size(); ++i) {
+      ret[i] = SX(ex[i].sparsity(), vector<SXElem>(it, it+ex[i].nnz()), false);
+      it += ex[i].nnz();
+    }
+    return ret;
   }
 
   template<>
@@ -32,6 +32,20 @@
 #include <stack>
 #include <typeinfo>
 
+#ifdef CASADI_WITH_THREAD
+#ifdef CASADI_WITH_THREAD_MINGW
+#include <mingw.thread.h>
+#include <mingw.mutex.h>
+#include <mingw.condition_variable.h>
+#else // CASADI_WITH_THREAD_MINGW
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#endif // CASADI_WITH_THREAD_MINGW
+#include <deque>
+#include <functional>
+#endif // CASADI_WITH_THREAD
+
 // Throw informative error message
 #define CASADI_THROW_ERROR(FNAME, WHAT) \
 throw CasadiException("Error in MXFunction::" FNAME " at " + CASADI_WHERE + ":\n"\
@@ -49,6 +63,98 @@ namespace casadi {
     XFunction<MXFunction, MX, MXNode>(name, inputv, outputv, name_in, name_out) {
   }
 
+#ifdef CASADI_WITH_THREAD
+  /** \brief Worker threads for parallel evaluation
+
+      The thread calling run takes part in the work and executes queued tasks,
+      also those of other calls, while waiting. Calls may therefore come from
+      several threads at once and from within a task without deadlocking.
+  */
+  class MXFunction::ThreadPool {
+  public:
+    // Start n worker threads
+    explicit ThreadPool(casadi_int n) : stop_(false) {
+      for (casadi_int i=0; i<n; ++i) workers_.emplace_back([this]() { work();});
+    }
+
+    // Stop and join the worker threads
+    ~ThreadPool() {
+      {
+        std::lock_guard<std::mutex> lock(mtx_);
+        stop_ = true;
+      }
+      cv_task_.notify_all();
+      for (auto&& th : workers_) th.join();
+    }
+
+    // Call f(t) for t=0, ..., n-1 and wait for all calls to finish, f must not throw
+    void run(casadi_int n, const std::function<void(casadi_int)>& f) {
+      // Number of unfinished calls, protected by the mutex
+      casadi_int remaining = n-1;
+      {
+        std::lock_guard<std::mutex> lock(mtx_);
+        for (casadi_int t=1; t<n; ++t) tasks_.push_back({&f, t, &remaining});
+      }
+      cv_task_.notify_all();
+      // The first call on this thread
+      f(0);
+      // Help out until all calls have finished
+      std::unique_lock<std::mutex> lock(mtx_);
+      while (remaining>0) {
+        if (tasks_.empty()) {
+          cv_done_.wait(lock);
+        } else {
+          Task task = tasks_.front();
+          tasks_.pop_front();
+          lock.unlock();
+          execute(task);
+          lock.lock();
+        }
+      }
+    }
+
+  private:
+    // Call of a function, with the counter of the run it belongs to
+    struct Task {
+      const std::function<void(casadi_int)>* f;
+      casadi_int t;
+      casadi_int* remaining;
+    };
+
+    // Execute a task and mark it as finished
+    void execute(const Task& task) {
+      (*task.f)(task.t);
+      {
+        std::lock_guard<std::mutex> lock(mtx_);
+        --*task.remaining;
+      }
+      cv_done_.notify_all();
+    }
+
+    // Main loop of a worker thread
+    void work() {
+      std::unique_lock<std::mutex> lock(mtx_);
+      while (true) {
+        cv_task_.wait(lock, [this]() { return stop_ || !tasks_.empty();});
+        if (tasks_.empty()) return;
+        Task task = tasks_.front();
+        tasks_.pop_front();
+        lock.unlock();
+        execute(task);
+        lock.lock();
+      }
+    }
+
+    std::vector<std::thread> workers_;
+    std::deque<Task> tasks_;
+    std::mutex mtx_;
+    std::condition_variable cv_task_, cv_done_;
+    bool stop_;
+  };
+#else // CASADI_WITH_THREAD
+  class MXFunction::ThreadPool {};
+#endif // CASADI_WITH_THREAD
+
   MXFunction::~MXFunction() {
   }
 
@@ -59,7 +165,15 @@ namespace casadi {
         "Default input values"}},
       {"live_variables",
        {OT_BOOL,
-        "Reuse variables in the work vector"}}
+        "Reuse variables in the work vector [default: true unless parallel]"}},
+      {"parallel",
+       {OT_BOOL,
+        "Evaluate independent function calls in parallel. "
+        "Requires CasADi to be compiled with thread support"}},
+      {"parallel_threads",
+       {OT_INT,
+        "Maximum number of threads for parallel evaluation, "
+        "including the calling thread [number of hardware threads]"}}
      }
   };
 
@@ -95,15 +209,32 @@ namespace casadi {
     // Default (temporary) options
     bool live_variables = true;
 
+    // Default options
+    parallel_ = false;
+#ifdef CASADI_WITH_THREAD
+    casadi_int parallel_threads = std::thread::hardware_concurrency();
+#else // CASADI_WITH_THREAD
+    casadi_int parallel_threads = 1;
+#endif // CASADI_WITH_THREAD
+
     // Read options
     for (auto&& op : opts) {
       if (op.first=="default_in") {
         default_in_ = op.second;
       } else if (op.first=="live_variables") {
         live_variables = op.second;
+      } else if (op.first=="parallel") {
+        parallel_ = op.second;
+      } else if (op.first=="parallel_threads") {
+        parallel_threads = op.second;
       }
     }
 
+#ifdef CASADI_WITH_THREAD
+    // Reusing work vector elements would serialize independent function calls
+    if (parallel_ && opts.find("live_variables")==opts.end()) live_variables = false;
+#endif // CASADI_WITH_THREAD
+
     // Check/set default inputs
     if (default_in_.empty()) {
       default_in_.resize(n_in_, 0);
@@ -113,11 +244,14 @@ namespace casadi {
     }
 
     // Stack used to sort the computational graph
-    stack<MXNode*> s;
+    vector<MXNode*> s;
 
     // All nodes
     vector<MXNode*> nodes;
 
+    // Place of each node in the sorted graph
+    NodeMarker<MXNode> place_in_graph;
+
     // Add the list of nodes
     for (casadi_int ind=0; ind<out_.size(); ++ind) {
       // Loop over primitives of each output
@@ -125,8 +259,8 @@ namespace casadi {
       casadi_int nz_offset=0;
       for (casadi_int p=0; p<prim.size(); ++p) {
         // Get the nodes using a depth first search
-        s.push(prim[p].get());
-        sort_depth_first(s, nodes);
+        s.push_back(prim[p].get());
+        sort_depth_first(s, nodes, place_in_graph);
         // Add an output instruction ("data" below will take ownership)
         nodes.push_back(new Output(prim[p], ind, p, nz_offset));
         // Update offset
@@ -136,7 +270,7 @@ namespace casadi {
 
     // Set the temporary variables to be the corresponding place in the sorted graph
     for (casadi_int i=0; i<nodes.size(); ++i) {
-      nodes[i]->temp = i;
+      place_in_graph.set(nodes[i], i);
     }
 
     // Place in the algorithm for each node
@@ -169,13 +303,13 @@ namespace casadi {
         ae.data.own(n);
         ae.arg.resize(n->n_dep());
         for (casadi_int i=0; i<n->n_dep(); ++i) {
-          ae.arg[i] = n->dep(i)->temp;
+          ae.arg[i] = place_in_graph.get(n->dep(i).get());
         }
         ae.res.resize(n->nout());
         if (n->has_output()) {
           fill(ae.res.begin(), ae.res.end(), -1);
         } else if (!ae.res.empty()) {
-          ae.res[0] = n->temp;
+          ae.res[0] = place_in_graph.get(n);
         }
 
         // Increase the reference count of the dependencies
@@ -194,14 +328,16 @@ namespace casadi {
         casadi_int oind = n->which_output();
 
         // Get the index of the parent node
-        casadi_int pind = place_in_alg[n->dep(0)->temp];
+        casadi_int pind = place_in_alg[place_in_graph.get(n->dep(0).get())];
 
         // Save location in the algorithm element corresponding to the parent node
         casadi_int& otmp = algorithm_[pind].res.at(oind);
         if (otmp<0) {
-          otmp = n->temp; // First time this function output is encountered, save to algorithm
+          // First time this function output is encountered, save to algorithm
+          otmp = place_in_graph.get(n);
         } else {
-          n->temp = otmp; // Function output is a duplicate, use the node encountered first
+          // Function output is a duplicate, use the node encountered first
+          place_in_graph.set(n, otmp);
         }
 
         // Not in the algorithm
@@ -213,8 +349,14 @@ namespace casadi {
     vector<casadi_int>& place = place_in_alg; // Reuse memory as it is no longer needed
     place.resize(nodes.size());
 
-    // Stack with unused elements in the work vector, sorted by sparsity pattern
-    SPARSITY_MAP<casadi_int, stack<casadi_int> > unused_all;
+    // Stack with unused elements in the work vector, sorted by their size
+    std::map<casadi_int, stack<casadi_int> > unused_all;
+
+    // Size of each element in the work vector
+    vector<casadi_int> worknnz;
+
+    // Elements freed by arguments that may be overwritten by the result (index, nnz)
+    vector<pair<casadi_int, casadi_int> > inplace_free;
 
     // Work vector size
     casadi_int worksize = 0;
@@ -243,12 +385,13 @@ namespace casadi {
 
             // Free variable for reuse
             if (live_variables && remaining==0) {
-
-              // Get a pointer to the sparsity pattern of the argument that can be freed
-              casadi_int nnz = nodes[ch_ind]->sparsity().nnz();
-
-              // Add to the stack of unused work vector elements for the current sparsity
-              unused_all[nnz].push(place[ch_ind]);
+              if (task==0) {
+                // Candidate for inplace operation, only if the size matches the result
+                inplace_free.push_back(make_pair(place[ch_ind], nodes[ch_ind]->sparsity().nnz()));
+              } else {
+                // Add to the stack of unused work vector elements of this size
+                unused_all[worknnz[place[ch_ind]]].push(place[ch_ind]);
+              }
             }
 
             // Point to the place in the work vector instead of to the place in the list of nodes
@@ -266,27 +409,41 @@ namespace casadi {
         // Allocate/reuse memory for the results of the operation
         for (casadi_int c=0; c<e.res.size(); ++c) {
           if (e.res[c]>=0) {
+            casadi_int nnz = e.data->sparsity(c).nnz();
 
             // Are reuse of variables (live variables) enabled?
             if (live_variables) {
-              // Get a pointer to the sparsity pattern node
-              casadi_int nnz = e.data->sparsity(c).nnz();
-
-              // Get a reference to the stack for the current sparsity
-              stack<casadi_int>& unused = unused_all[nnz];
+              // Overwrite an argument if possible, first argument first
+              auto it_inplace = inplace_free.rbegin();
+              while (it_inplace!=inplace_free.rend() && it_inplace->second!=nnz) ++it_inplace;
+              if (it_inplace!=inplace_free.rend()) {
+                e.res[c] = place[e.res[c]] = it_inplace->first;
+                inplace_free.erase(std::next(it_inplace).base());
+                continue; // Success, operation performed inplace
+              }
 
-              // Try to reuse a variable from the stack if possible (last in, first out)
-              if (!unused.empty()) {
-                e.res[c] = place[e.res[c]] = unused.top();
-                unused.pop();
+              // Try to reuse an element of the same size, or for nonscalars the
+              // smallest element that is large enough (last in, first out)
+              auto it = unused_all.lower_bound(nnz);
+              if (nnz>1) {
+                while (it!=unused_all.end() && it->second.empty()) ++it;
+              }
+              if (it!=unused_all.end() && !it->second.empty() && (nnz>1 || it->first==nnz)) {
+                e.res[c] = place[e.res[c]] = it->second.top();
+                it->second.pop();
                 continue; // Success, no new element needed in the work vector
               }
             }
 
             // Allocate a new element in the work vector
             e.res[c] = place[e.res[c]] = worksize++;
+            worknnz.push_back(nnz);
           }
         }
+
+        // Arguments that were not overwritten can be reused by later operations
+        for (auto&& f : inplace_free) unused_all[worknnz[f.first]].push(f.first);
+        inplace_free.clear();
       }
     }
 
@@ -303,13 +460,14 @@ namespace casadi {
     workloc_.resize(worksize+1);
     fill(workloc_.begin(), workloc_.end(), -1);
     size_t wind=0, sz_w=0;
+    par_sz_arg_ = par_sz_res_ = par_sz_iw_ = 0;
     for (auto&& e : algorithm_) {
       if (e.op!=OP_OUTPUT) {
         for (casadi_int c=0; c<e.res.size(); ++c) {
           if (e.res[c]>=0) {
-            alloc_arg(e.data->sz_arg());
-            alloc_res(e.data->sz_res());
-            alloc_iw(e.data->sz_iw());
+            par_sz_arg_ = max(par_sz_arg_, e.data->sz_arg());
+            par_sz_res_ = max(par_sz_res_, e.data->sz_res());
+            par_sz_iw_ = max(par_sz_iw_, e.data->sz_iw());
             sz_w = max(sz_w, e.data->sz_w());
             if (workloc_[e.res[c]] < 0) {
               workloc_[e.res[c]] = wind;
@@ -324,13 +482,28 @@ namespace casadi {
       if (workloc_[i]<0) workloc_[i] = i==0 ? 0 : workloc_[i-1];
       workloc_[i] += sz_w;
     }
+    par_sz_w_ = sz_w;
     sz_w += wind;
-    alloc_w(sz_w);
+
+    // Schedule independent function calls for parallel evaluation
+    par_nthread_ = 1;
+    if (parallel_) schedule_parallel(parallel_threads);
+
+    // Each additional thread gets its own temporary work vectors
+    alloc_arg(par_nthread_*par_sz_arg_);
+    alloc_res(par_nthread_*par_sz_res_);
+    alloc_iw(par_nthread_*par_sz_iw_);
+    alloc_w(sz_w + (par_nthread_-1)*par_sz_w_);
+
+    if (verbose_) {
+      casadi_message("Work vector has " + str(wind) + " nonzeros for " + str(worksize)
+                     + " elements, " + str(sz_w) + " in total");
+    }
 
     // Reset the temporary variables
     for (casadi_int i=0; i<nodes.size(); ++i) {
       if (nodes[i]) {
-        nodes[i]->temp = 0;
+        place_in_graph.reset(nodes[i]);
       }
     }
 
@@ -395,39 +568,167 @@ namespace casadi {
                    + str(free_vars_) + " are free.");
     }
 
+    // Evaluate independent function calls in parallel
+    if (par_nthread_>1) return eval_parallel(arg, res, iw, w);
+
     // Evaluate all of the nodes of the algorithm:
     // should only evaluate nodes that have not yet been calculated!
     for (auto&& e : algorithm_) {
-      if (e.op==OP_INPUT) {
-        // Pass an input
-        double *w1 = w+workloc_[e.res.front()];
-        casadi_int nnz=e.data.nnz();
-        casadi_int i=e.data->ind();
-        casadi_int nz_offset=e.data->offset();
-        if (arg[i]==nullptr) {
-          fill(w1, w1+nnz, 0);
-        } else {
-          copy(arg[i]+nz_offset, arg[i]+nz_offset+nnz, w1);
-        }
-      } else if (e.op==OP_OUTPUT) {
-        // Get an output
-        double *w1 = w+workloc_[e.arg.front()];
-        casadi_int nnz=e.data->dep().nnz();
-        casadi_int i=e.data->ind();
-        casadi_int nz_offset=e.data->offset();
-        if (res[i]) copy(w1, w1+nnz, res[i]+nz_offset);
+      if (eval_el(e, arg, res, w, arg1, res1, iw, w)) return 1;
+    }
+    return 0;
+  }
+
+  int MXFunction::eval_el(const AlgEl& e, const double** arg, double** res, double* w,
+                          const double** arg1, double** res1,
+                          casadi_int* iw1, double* w1) const {
+    if (e.op==OP_INPUT) {
+      // Pass an input
+      double *w2 = w+workloc_[e.res.front()];
+      casadi_int nnz=e.data.nnz();
+      casadi_int i=e.data->ind();
+      casadi_int nz_offset=e.data->offset();
+      if (arg[i]==nullptr) {
+        fill(w2, w2+nnz, 0);
       } else {
-        // Point pointers to the data corresponding to the element
-        for (casadi_int i=0; i<e.arg.size(); ++i)
-          arg1[i] = e.arg[i]>=0 ? w+workloc_[e.arg[i]] : nullptr;
-        for (casadi_int i=0; i<e.res.size(); ++i)
-          res1[i] = e.res[i]>=0 ? w+workloc_[e.res[i]] : nullptr;
+        copy(arg[i]+nz_offset, arg[i]+nz_offset+nnz, w2);
+      }
+    } else if (e.op==OP_OUTPUT) {
+      // Get an output
+      double *w2 = w+workloc_[e.arg.front()];
+      casadi_int nnz=e.data->dep().nnz();
+      casadi_int i=e.data->ind();
+      casadi_int nz_offset=e.data->offset();
+      if (res[i]) copy(w2, w2+nnz, res[i]+nz_offset);
+    } else {
+      // Point pointers to the data corresponding to the element
+      for (casadi_int i=0; i<e.arg.size(); ++i)
+        arg1[i] = e.arg[i]>=0 ? w+workloc_[e.arg[i]] : nullptr;
+      for (casadi_int i=0; i<e.res.size(); ++i)
+        res1[i] = e.res[i]>=0 ? w+workloc_[e.res[i]] : nullptr;
+
+      // Evaluate
+      if (e.data->eval(arg1, res1, iw1, w1)) return 1;
+    }
+    return 0;
+  }
 
-        // Evaluate
-        if (e.data->eval(arg1, res1, iw, w)) return 1;
+  void MXFunction::schedule_parallel(casadi_int max_threads) {
+#ifdef CASADI_WITH_THREAD
+    // Level of each instruction: after the instructions that last wrote to its
+    // arguments and after the instructions that read or wrote its results before
+    casadi_int nw = workloc_.size()-1;
+    vector<casadi_int> last_write(nw, -1), last_read(nw, -1);
+    vector<casadi_int> level(algorithm_.size());
+    casadi_int nlevel = 0;
+    for (casadi_int k=0; k<algorithm_.size(); ++k) {
+      const AlgEl& e = algorithm_[k];
+      casadi_int l = 0;
+      for (casadi_int i : e.arg) if (i>=0) l = max(l, last_write[i]+1);
+      for (casadi_int i : e.res) if (i>=0) l = max(l, max(last_write[i], last_read[i])+1);
+      for (casadi_int i : e.arg) if (i>=0) last_read[i] = max(last_read[i], l);
+      for (casadi_int i : e.res) if (i>=0) last_write[i] = l;
+      level[k] = l;
+      nlevel = max(nlevel, l+1);
+    }
+
+    // Sort by level, function calls last, otherwise keeping the order of the algorithm
+    vector<casadi_int> count(2*nlevel+1, 0);
+    for (casadi_int k=0; k<algorithm_.size(); ++k) {
+      count[2*level[k] + (algorithm_[k].op==OP_CALL) + 1]++;
+    }
+    for (casadi_int i=0; i<2*nlevel; ++i) count[i+1] += count[i];
+    par_level_.resize(nlevel+1);
+    par_call_.resize(nlevel);
+    for (casadi_int l=0; l<nlevel; ++l) {
+      par_level_[l] = count[2*l];
+      par_call_[l] = count[2*l+1];
+    }
+    par_level_.back() = algorithm_.size();
+    par_order_.resize(algorithm_.size());
+    for (casadi_int k=0; k<algorithm_.size(); ++k) {
+      par_order_[count[2*level[k] + (algorithm_[k].op==OP_CALL)]++] = k;
+    }
+
+    // Maximum number of function calls that can be evaluated concurrently
+    casadi_int max_calls = 0;
+    for (casadi_int l=0; l<nlevel; ++l) {
+      max_calls = max(max_calls, par_level_[l+1]-par_call_[l]);
+    }
+
+    // One thread per function call, limited by the parallel_threads option
+    par_nthread_ = max(casadi_int(1), min(max_calls, max_threads));
+
+    // The calling thread takes part in the evaluation
+    if (par_nthread_>1) par_pool_.reset(new ThreadPool(par_nthread_-1));
+
+    if (verbose_) {
+      casadi_message("Parallel evaluation: " + str(nlevel) + " levels, up to "
+                     + str(max_calls) + " concurrent function calls on "
+                     + str(par_nthread_) + " threads");
+    }
+#else // CASADI_WITH_THREAD
+    if (verbose_) {
+      casadi_message("Parallel evaluation disabled: CasADi was compiled without thread support");
+    }
+#endif // CASADI_WITH_THREAD
+  }
+
+  int MXFunction::eval_parallel(const double** arg, double** res,
+      casadi_int* iw, double* w) const {
+#ifdef CASADI_WITH_THREAD
+    // Work vectors of the main thread
+    const double** arg1 = arg+n_in_;
+    double** res1 = res+n_out_;
+
+    // Evaluate one level at a time
+    for (casadi_int l=0; l<par_call_.size(); ++l) {
+      // Evaluate the cheap instructions in sequence
+      for (casadi_int k=par_level_[l]; k<par_call_[l]; ++k) {
+        if (eval_el(algorithm_[par_order_[k]], arg, res, w, arg1, res1, iw, w)) return 1;
+      }
+
+      // Number of threads for the function calls
+      casadi_int ncall = par_level_[l+1]-par_call_[l];
+      casadi_int nthread = min(ncall, par_nthread_);
+      if (nthread==1) {
+        if (eval_el(algorithm_[par_order_[par_call_[l]]], arg, res, w, arg1, res1, iw, w)) {
+          return 1;
+        }
+        continue;
       }
+
+      // Return values and exceptions of each thread
+      std::vector<int> ret_values(nthread, 0);
+      std::vector<std::exception_ptr> ex(nthread);
+
+      // Thread t evaluates calls t, t+nthread, ... of the level
+      par_pool_->run(nthread, [&](casadi_int t) {
+        // Temporary work vectors of the thread, the first thread uses those of the main thread
+        const double** arg_t = arg1 + t*par_sz_arg_;
+        double** res_t = res1 + t*par_sz_res_;
+        casadi_int* iw_t = iw + t*par_sz_iw_;
+        double* w_t = t==0 ? w : w + workloc_.back() + (t-1)*par_sz_w_;
+        try {
+          for (casadi_int k=par_call_[l]+t; k<par_level_[l+1]; k+=nthread) {
+            if (eval_el(algorithm_[par_order_[k]], arg, res, w, arg_t, res_t, iw_t, w_t)) {
+              ret_values[t] = 1;
+              break;
+            }
+          }
+        } catch (...) {
+          ex[t] = std::current_exception();
+        }
+      });
+
+      // Propagate errors, in the order of the threads
+      for (auto&& e : ex) if (e) std::rethrow_exception(e);
+      for (int e : ret_values) if (e) return 1;
     }
     return 0;
+#else // CASADI_WITH_THREAD
+    casadi_error("Parallel evaluation requires CasADi to be compiled with thread support");
+#endif // CASADI_WITH_THREAD
   }
 
   string MXFunction::print(const AlgEl& el) const {
@@ -28,6 +28,7 @@
 
 #include <set>
 #include <map>
+#include <memory>
 #include <vector>
 #include <iostream>
 
@@ -77,6 +78,23 @@ namespace casadi {
     /// Default input values
     std::vector<double> default_in_;
 
+    /// Evaluate independent function calls in parallel
+    bool parallel_;
+
+    /** \brief Evaluation order for parallel evaluation, grouped into levels of
+     * independent instructions with the function calls at the end of each level */
+    std::vector<casadi_int> par_order_, par_level_, par_call_;
+
+    /// Number of threads for parallel evaluation
+    casadi_int par_nthread_;
+
+    /// Worker threads, kept alive between levels and evaluations
+    class ThreadPool;
+    std::unique_ptr<ThreadPool> par_pool_;
+
+    /// Size of the work vectors of each thread
+    size_t par_sz_arg_, par_sz_res_, par_sz_iw_, par_sz_w_;
+
     /** \brief Constructor */
     MXFunction(const std::string& name,
       const std::vector<MX>& input, const std::vector<MX>& output,
@@ -89,6 +107,13 @@ namespace casadi {
     /** \brief  Evaluate numerically, work vectors given */
     int eval(const double** arg, double** res, casadi_int* iw, double* w, void* mem) const override;
 
+    /** \brief  Evaluate an instruction, thread-local work vectors given */
+    int eval_el(const AlgEl& e, const double** arg, double** res, double* w,
+                const double** arg1, double** res1, casadi_int* iw1, double* w1) const;
+
+    /** \brief  Evaluate with independent function calls in parallel */
+    int eval_parallel(const double** arg, double** res, casadi_int* iw, double* w) const;
+
     /** \brief  Print description */
     void disp_more(std::ostream& stream) const override;
 
@@ -110,6 +135,9 @@ namespace casadi {
     /** \brief  Initialize */
     void init(const Dict& opts) override;
 
+    /** \brief  Group the algorithm into levels of independent instructions */
+    void schedule_parallel(casadi_int max_threads);
+
     /** \brief Generate code for the declarations of the C function */
     void codegen_declarations(CodeGenerator& g) const override;
 
@@ -234,48 +234,76 @@ namespace casadi {
   }
 
   void MXNode::can_inline(std::map<const MXNode*, casadi_int>& nodeind) const {
-    // Add or mark node in map
-    std::map<const MXNode*, casadi_int>::iterator it=nodeind.find(this);
-    if (it==nodeind.end()) {
-      // First time encountered, mark inlined
-      nodeind.insert(it, make_pair(this, 0));
-
-      // Handle dependencies with recursion
-      for (casadi_int i=0; i<n_dep(); ++i) {
-        dep(i)->can_inline(nodeind);
+    // Nodes to be visited, without recursion
+    std::vector<const MXNode*> stack(1, this);
+    while (!stack.empty()) {
+      const MXNode* n = stack.back();
+      stack.pop_back();
+      // Add or mark node in map
+      std::map<const MXNode*, casadi_int>::iterator it=nodeind.find(n);
+      if (it==nodeind.end()) {
+        // First time encountered, mark inlined
+        nodeind.insert(it, make_pair(n, 0));
+
+        // Handle dependencies
+        for (casadi_int i=n->n_dep(); i-->0; ) {
+          stack.push_back(n->dep(i).get());
+        }
+      } else if (it->second==0 && n->op()!=OP_PARAMETER) {
+        // Node encountered before, do not inline (except if symbolic primitive)
+        it->second = -1;
       }
-    } else if (it->second==0 && op()!=OP_PARAMETER) {
-      // Node encountered before, do not inline (except if symbolic primitive)
-      it->second = -1;
     }
   }
 
   std::string MXNode::print_compact(std::map<const MXNode*, casadi_int>& nodeind,
-                                   vector<std::string>& intermed) const {
-    // Get reference to node index
-    casadi_int& ind = nodeind[this];
-
-    // If positive, already in intermediate expressions
-    if (ind>0) return "@" + str(ind);
-
-    // Get expressions for dependencies
-    vector<string> arg(n_dep());
-    for (casadi_int i=0; i<arg.size(); ++i) {
-      arg[i] = dep(i)->print_compact(nodeind, intermed);
-    }
-
-    // Get expression for this
-    string s = disp(arg);
+                                   std::vector<std::string>& intermed) const {
+    // Node being printed, with the expressions for the dependencies printed so far
+    struct Frame {
+      const MXNode* n;
+      casadi_int next;
+      std::vector<std::string> arg;
+    };
+
+    // Nodes being printed, without recursion
+    std::vector<Frame> stack(1);
+    stack.back().n = this;
+    stack.back().next = 0;
+    std::string s;
+    while (true) {
+      Frame& f = stack.back();
+
+      // Get reference to node index
+      casadi_int& ind = nodeind[f.n];
+
+      if (f.next==0 && ind>0) {
+        // If positive, already in intermediate expressions
+        s = "@" + str(ind);
+      } else if (f.next<f.n->n_dep()) {
+        // Get expression for the next dependency
+        Frame d;
+        d.n = f.n->dep(f.next).get();
+        d.next = 0;
+        stack.push_back(d);
+        continue;
+      } else {
+        // Get expression for this
+        s = f.n->disp(f.arg);
+
+        // Decide what to do with the expression
+        if (ind!=0) {
+          // Add to list of intermediate expressions and return reference
+          intermed.push_back(s);
+          ind = intermed.size(); // For subsequent references
+          s = "@" + str(ind);
+        }
+      }
 
-    // Decide what to do with the expression
-    if (ind==0) {
-      // Inline expression
-      return s;
-    } else {
-      // Add to list of intermediate expressions and return reference
-      intermed.push_back(s);
-      ind = intermed.size(); // For subsequent references
-      return "@" + str(ind);
+      // Pass the expression to the parent node
+      stack.pop_back();
+      if (stack.empty()) return s;
+      stack.back().arg.push_back(s);
+      stack.back().next++;
     }
   }
 
@@ -771,6 +799,23 @@ namespace casadi {
     return MX::create(new MMax(shared_from_this<MX>()));
   }
 
+  /** \brief Concatenate nonzeros taken from the same expression with a single GetNonzeros
+   * Returns false if the nonzeros are not all taken from the same expression
+   */
+  static bool concat_nonzeros(const vector<MX>& x, const Sparsity& sp, MX& ret) {
+    for (auto&& i : x) {
+      if (i.op()!=OP_GETNONZEROS || i->dep().get()!=x.front()->dep().get()) return false;
+    }
+    vector<casadi_int> nz;
+    nz.reserve(sp.nnz());
+    for (auto&& i : x) {
+      vector<casadi_int> nz_i = static_cast<const GetNonzeros*>(i.get())->all();
+      nz.insert(nz.end(), nz_i.begin(), nz_i.end());
+    }
+    ret = x.front()->dep()->get_nzref(sp, nz);
+    return true;
+  }
+
   MX MXNode::get_horzcat(const vector<MX>& x) const {
     // Check if there is any existing horzcat operation
     for (auto i=x.begin(); i!=x.end(); ++i) {
@@ -788,11 +833,23 @@ namespace casadi {
       }
     }
 
+    // Concatenation of nonzeros of the same expression
+    vector<Sparsity> sp(x.size());
+    for (casadi_int i=0; i<x.size(); ++i) sp[i] = x[i].sparsity();
+    MX ret;
+    if (concat_nonzeros(x, Sparsity::horzcat(sp), ret)) return ret;
+
     // Create a Horzcat node
     return MX::create(new Horzcat(x));
   }
 
   MX MXNode::get_diagcat(const vector<MX>& x) const {
+    // Concatenation of nonzeros of the same expression
+    vector<Sparsity> sp(x.size());
+    for (casadi_int i=0; i<x.size(); ++i) sp[i] = x[i].sparsity();
+    MX ret;
+    if (concat_nonzeros(x, Sparsity::diagcat(sp), ret)) return ret;
+
     // Create a Horzcat node
     return MX::create(new Diagcat(x));
   }
@@ -814,6 +871,12 @@ namespace casadi {
       }
     }
 
+    // Concatenation of nonzeros of the same expression
+    vector<Sparsity> sp(x.size());
+    for (casadi_int i=0; i<x.size(); ++i) sp[i] = x[i].sparsity();
+    MX ret;
+    if (concat_nonzeros(x, Sparsity::vertcat(sp), ret)) return ret;
+
     return MX::create(new Vertcat(x));
   }
 
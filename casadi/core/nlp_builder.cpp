@@ -26,6 +26,8 @@
 #include "nlp_builder.hpp"
 #include "core.hpp"
 #include <fstream>
+#include <cstring>
+#include <cstdlib>
 
 using namespace std;
 namespace casadi {
@@ -49,32 +51,48 @@ namespace casadi {
   : nlp_(nlp) {
     // Set default options
     verbose_=false;
+    expand_=false;
 
     // Read user options
     for (auto&& op : opts) {
       if (op.first == "verbose") {
         verbose_ = op.second;
+      } else if (op.first == "expand") {
+        expand_ = op.second;
       } else {
         stringstream ss;
         ss << "Unknown option \"" << op.first << "\"" << endl;
         throw CasadiException(ss.str());
       }
     }
-    // Open file for reading
-    s_.open(filename.c_str());
+    // Read the whole file into memory
     if (verbose_) casadi_message("Reading file \"" + filename + "\"");
+    ifstream s(filename.c_str(), ifstream::binary);
+    casadi_assert(s.good(), "Cannot open file \"" + filename + "\"");
+    s.seekg(0, ifstream::end);
+    buf_.resize(static_cast<size_t>(s.tellg()) + 1);
+    s.seekg(0, ifstream::beg);
+    s.read(buf_.data(), buf_.size()-1);
+    casadi_assert(s.good(), "Failed to read file \"" + filename + "\"");
+    s.close();
+    buf_.back() = '\0';
+    pos_ = 0;
+    eof_ = false;
 
     // Read the header of the NL-file (first 10 lines)
     const casadi_int header_sz = 10;
     vector<string> header(header_sz);
     for (casadi_int k=0; k<header_sz; ++k) {
-      getline(s_, header[k]);
+      size_t end = pos_;
+      while (end<buf_.size()-1 && buf_[end]!='\n') end++;
+      header[k] = string(buf_.data()+pos_, buf_.data()+end);
+      pos_ = end<buf_.size()-1 ? end+1 : end;
     }
 
     // Assert that the file is not in binary form
-    if (header.at(0).at(0)=='g') {
+    if (!header.at(0).empty() && header.at(0).at(0)=='g') {
       binary_ = false;
-    } else if (header.at(0).at(0)=='b') {
+    } else if (!header.at(0).empty() && header.at(0).at(0)=='b') {
       binary_ = true;
     } else {
       casadi_error("File could not be read");
@@ -108,10 +126,6 @@ namespace casadi {
     // Allocate variables
     nlp_.x = MX::sym("x", 1, 1, n_var_);
 
-    // Allocate f and c
-    nlp_.f = 0;
-    nlp_.g.resize(n_con_, 0);
-
     // Allocate bounds for x and primal initial guess
     nlp_.x_lb.resize(n_var_, -inf);
     nlp_.x_ub.resize(n_var_,  inf);
@@ -157,29 +171,40 @@ namespace casadi {
     casadi_assert(nlp_.discrete.size()==n_var_,
       "Number of variables in the header don't match");
 
-    // All variables, including dependent
-    v_ = nlp_.x;
-
-    if (binary_) {
-      streampos offset = s_.tellg();
-      s_.close();
-      s_.open(filename.c_str(), std::ifstream::binary);
-      s_.seekg(offset);
+    // Objective sign, in case there is no objective
+    sign_ = 1;
+
+    if (expand_) {
+      // Build scalar expressions
+      sx_.v = SX::sym("x", 1, 1, n_var_);
+      sx_.f = 0;
+      sx_.g.resize(n_con_, 0);
+      parse(sx_);
+
+      // Expose the expressions as a single call to an SX Function
+      Function nlp("nlp", {vertcat(vector<SX>(sx_.v.begin(), sx_.v.begin()+n_var_))},
+                   {sign_*sx_.f, vertcat(sx_.g)});
+      vector<MX> r = nlp(vector<MX>{vertcat(nlp_.x)});
+      nlp_.f = r.at(0);
+      nlp_.g = n_con_>0 ? vertsplit(r.at(1)) : vector<MX>();
+    } else {
+      // Build expression graph
+      mx_.v = nlp_.x;
+      mx_.f = 0;
+      mx_.g.resize(n_con_, 0);
+      parse(mx_);
+
+      // multiple the objective sign
+      nlp_.f = sign_*mx_.f;
+      nlp_.g = mx_.g;
     }
-
-    // Read segments
-    parse();
-
-    // multiple the objective sign
-    nlp_.f = sign_*nlp_.f;
   }
 
   NlImporter::~NlImporter() {
-    // Close the NL file
-    s_.close();
   }
 
-  void NlImporter::parse() {
+  template<typename T>
+  void NlImporter::parse(Expressions<T>& e) {
     // Segment key
     char key;
 
@@ -187,221 +212,235 @@ namespace casadi {
     while (true) {
       // Read segment key
       key = read_char();
-      if (s_.eof()) break; // end of file encountered
+      if (eof_) break; // end of file encountered
       switch (key) {
         case 'F': F_segment(); break;
         case 'S': S_segment(); break;
-        case 'V': V_segment(); break;
-        case 'C': C_segment(); break;
+        case 'V': V_segment(e); break;
+        case 'C': C_segment(e); break;
         case 'L': L_segment(); break;
-        case 'O': O_segment(); break;
+        case 'O': O_segment(e); break;
         case 'd': d_segment(); break;
         case 'x': x_segment(); break;
         case 'r': r_segment(); break;
         case 'b': b_segment(); break;
         case 'k': k_segment(); break;
-        case 'J': J_segment(); break;
-        case 'G': G_segment(); break;
+        case 'J': J_segment(e); break;
+        case 'G': G_segment(e); break;
         default: casadi_error("Unknown .nl segment");
       }
     }
   }
 
-  MX NlImporter::expr() {
-    // Read the instruction
-    char inst = read_char();
-
-    // Temporaries
-    int i;
-    double d;
-
-    // Error message
-    stringstream msg;
-
-    // Process instruction
-    switch (inst) {
-
-      // Symbolic variable
-      case 'v':
-      // Read the variable number
-      i = read_int();
-
-      // Return the corresponding expression
-      return v_.at(i);
-
-      // Numeric expression
-      case 'n':
+  casadi_int NlImporter::n_args(int op, std::vector<double>& pl) {
+    switch (op) {
+      // Unary operations, class 1 in Gay2005
+      case 13:  case 14:  case 15:  case 16:  case 34:  case 37:  case 38:  case 39:  case 40:
+      case 41:  case 43:  case 42:  case 44:  case 45:  case 46:  case 47:  case 49:  case 50:
+      case 51:  case 52:  case 53:
+      return 1;
+
+      // Binary operations, class 2 in Gay2005
+      case 0:   case 1:   case 2:   case 3:   case 4:   case 5:   case 6:   case 20:  case 21:
+      case 22:  case 23:  case 24:  case 28:  case 29:  case 30:  case 48:  case 55:  case 56:
+      case 57:  case 58:  case 73:
+      return 2;
+
+      // N-ary operator, classes 2, 6 and 11 in Gay2005
+      case 11: case 12: case 54: case 59: case 60: case 61: case 70: case 71: case 74:
+      // Number of elements
+      return read_int();
+
+      // Piecewise linear terms, class 4 in Gay2005
+      case 64:
+      {
+        // Number of slopes, followed by alternating slopes and breakpoints
+        int n = read_int();
+        casadi_assert(n>0, "Piecewise linear term without slopes");
+        pl.resize(2*n-1);
+        for (double& d : pl) {
+          char inst = read_char();
+          switch (inst) {
+            case 'n': d = read_double(); break;
+            case 's': d = read_short(); break;
+            case 'l': d = static_cast<double>(read_long()); break;
+            default: casadi_error("Expected a number in piecewise linear term");
+          }
+        }
+        // The variable
+        return 1;
+      }
 
-      // Read the floating point number
-      d = read_double();
+      // If-then-else expressions, class 5 in Gay2005
+      case 35: case 72:
+      return 3;
 
-      // Return an expression containing the number
-      return d;
+      case 65:
+      casadi_error("Symbolic if-then-else expressions not supported");
 
-      // Numeric expression
-      case 's':
+      default:
+      casadi_error("Unknown operation: " + str(op));
+    }
+    return 0;
+  }
 
-      // Read the short number
-      d = read_short();
+  template<typename T>
+  T NlImporter::apply(const Operation& op, const T* arg) {
+    switch (op.op) {
+      // Unary operations
+      case 13:  return floor(arg[0]);
+      case 14:  return ceil(arg[0]);
+      case 15:  return fabs(arg[0]);
+      case 16:  return -arg[0];
+      case 34:  return logic_not(arg[0]);
+      case 37:  return tanh(arg[0]);
+      case 38:  return tan(arg[0]);
+      case 39:  return sqrt(arg[0]);
+      case 40:  return sinh(arg[0]);
+      case 41:  return sin(arg[0]);
+      case 42:  return log10(arg[0]);
+      case 43:  return log(arg[0]);
+      case 44:  return exp(arg[0]);
+      case 45:  return cosh(arg[0]);
+      case 46:  return cos(arg[0]);
+      case 47:  return atanh(arg[0]);
+      case 49:  return atan(arg[0]);
+      case 50:  return asinh(arg[0]);
+      case 51:  return asin(arg[0]);
+      case 52:  return acosh(arg[0]);
+      case 53:  return acos(arg[0]);
+
+      // Binary operations
+      case 0:   return arg[0] + arg[1];
+      case 1:   return arg[0] - arg[1];
+      case 2:   return arg[0] * arg[1];
+      case 3:   return arg[0] / arg[1];
+      // case 4:   return rem(x, y); FIXME
+      case 5:   return pow(arg[0], arg[1]);
+      // case 6:   return x < y; // TODO(Joel): Verify this,
+      // what is the difference to 'le' == 23 below?
+      case 20:  return logic_or(arg[0], arg[1]);
+      case 21:  return logic_and(arg[0], arg[1]);
+      case 22:  return arg[0] < arg[1];
+      case 23:  return arg[0] <= arg[1];
+      case 24:  return arg[0] == arg[1];
+      case 28:  return arg[0] >= arg[1];
+      case 29:  return arg[0] > arg[1];
+      case 30:  return arg[0] != arg[1];
+      case 48:  return atan2(arg[0], arg[1]);
+      // case 55:  return intdiv(x, y); // FIXME
+      // case 56:  return precision(x, y); // FIXME
+      // case 57:  return round(x, y); // FIXME
+      // case 58:  return trunc(x, y); // FIXME
+      // case 73:  return iff(x, y); // FIXME
+
+      // N-ary operations
+      case 11:
+      case 12:
+      {
+        casadi_assert(op.n>0, "Empty min/max");
+        T r = arg[0];
+        for (casadi_int k=1; k<op.n; ++k) r = op.op==11 ? fmin(r, arg[k]) : fmax(r, arg[k]);
+        return r;
+      }
+      // case 59: return count(args).scalar(); FIXME // rename?
+      // case 60: return numberof(args).scalar(); FIXME // rename?
+      // case 61: return numberofs(args).scalar(); FIXME // rename?
+      // case 70: return all(args).scalar(); FIXME // and in AMPL // rename?
+      // case 71: return any(args).scalar(); FIXME // or in AMPL // rename?
+      // case 74: return alldiff(args).scalar(); FIXME // rename?
+      case 54:
+      {
+        T r = 0;
+        for (casadi_int k=0; k<op.n; ++k) r += arg[k];
+        return r;
+      }
 
-      // Return an expression containing the number
-      return d;
+      // Piecewise linear term through the origin
+      case 64:
+      {
+        // Slope of the first piece, changes of slope at the breakpoints
+        T r = op.pl[0]*arg[0];
+        double r0 = 0;
+        for (casadi_int k=1; k<op.pl.size(); k+=2) {
+          double ds = op.pl[k+1]-op.pl[k-1], b = op.pl[k];
+          r += ds*fmax(arg[0]-b, 0);
+          r0 += ds*std::fmax(-b, 0);
+        }
+        return r - r0;
+      }
 
-      // Numeric expression
-      case 'l':
+      // If-then-else
+      case 35:
+      case 72:
+      return if_else(arg[0], arg[1], arg[2]);
 
-      // Read the short number
-      d = static_cast<double>(read_long());
+      default:
+      casadi_error("Unsupported operation: " + str(op.op));
+    }
+    return T();
+  }
 
-      // Return an expression containing the number
-      return d;
+  template<typename T>
+  T NlImporter::expr(const std::vector<T>& v) {
+    // Operations whose arguments are being read
+    vector<Operation> ops;
 
-      // Operation
-      case 'o':
+    // Arguments of the operations being read
+    vector<T> stack;
 
-      // Read the operation
-      i = read_int();
+    while (true) {
+      // Read the instruction
+      char inst = read_char();
+      casadi_assert(!eof_, "Unexpected end of file");
+      switch (inst) {
+        // Symbolic variable
+        case 'v':
+        stack.push_back(v.at(read_int()));
+        break;
 
-      // Process
-      switch (i) {
+        // Numeric expression
+        case 'n':
+        stack.push_back(read_double());
+        break;
 
-        // Unary operations, class 1 in Gay2005
-        case 13:  case 14:  case 15:  case 16:  case 34:  case 37:  case 38:  case 39:  case 40:
-        case 41:  case 43:  case 42:  case 44:  case 45:  case 46:  case 47:  case 49:  case 50:
-        case 51:  case 52:  case 53:
-        {
-          // Read dependency
-          MX x = expr();
-
-          // Perform operation
-          switch (i) {
-            case 13:  return floor(x);
-            case 14:  return ceil(x);
-            case 15:  return abs(x);
-            case 16:  return -x;
-            case 34:  return logic_not(x);
-            case 37:  return tanh(x);
-            case 38:  return tan(x);
-            case 39:  return sqrt(x);
-            case 40:  return sinh(x);
-            case 41:  return sin(x);
-            case 42:  return log10(x);
-            case 43:  return log(x);
-            case 44:  return exp(x);
-            case 45:  return cosh(x);
-            case 46:  return cos(x);
-            // case 47:  return atanh(x); FIXME
-            case 49:  return atan(x);
-            // case 50:  return asinh(x); FIXME
-            case 51:  return asin(x);
-            // case 52:  return acosh(x); FIXME
-            case 53:  return acos(x);
-
-            default:
-            casadi_error("Unknown unary operation: " + str(i));
-          }
-          break;
-        }
+        // Numeric expression
+        case 's':
+        stack.push_back(static_cast<double>(read_short()));
+        break;
 
-        // Binary operations, class 2 in Gay2005
-        case 0:   case 1:   case 2:   case 3:   case 4:   case 5:   case 6:   case 20:  case 21:
-        case 22:  case 23:  case 24:  case 28:  case 29:  case 30:  case 48:  case 55:  case 56:
-        case 57:  case 58:  case 73:
-        {
-          // Read dependencies
-          MX x = expr();
-          MX y = expr();
-
-          // Perform operation
-          switch (i) {
-            case 0:   return x + y;
-            case 1:   return x - y;
-            case 2:   return x * y;
-            case 3:   return x / y;
-            // case 4:   return rem(x, y); FIXME
-            case 5:   return pow(x, y);
-            // case 6:   return x < y; // TODO(Joel): Verify this,
-            // what is the difference to 'le' == 23 below?
-            case 20:  return logic_or(x, y);
-            case 21:  return logic_and(x, y);
-            case 22:  return x < y;
-            case 23:  return x <= y;
-            case 24:  return x == y;
-            case 28:  return x >= y;
-            case 29:  return x > y;
-            case 30:  return x != y;
-            case 48:  return atan2(x, y);
-            // case 55:  return intdiv(x, y); // FIXME
-            // case 56:  return precision(x, y); // FIXME
-            // case 57:  return round(x, y); // FIXME
-            // case 58:  return trunc(x, y); // FIXME
-            // case 73:  return iff(x, y); // FIXME
-
-            default:
-            casadi_error("Unknown binary operation: " + str(i));
-          }
-          break;
-        }
+        // Numeric expression
+        case 'l':
+        stack.push_back(static_cast<double>(read_long()));
+        break;
 
-        // N-ary operator, classes 2, 6 and 11 in Gay2005
-        case 11: case 12: case 54: case 59: case 60: case 61: case 70: case 71: case 74:
+        // Operation, its arguments follow
+        case 'o':
         {
-          // Number of elements in the sum
-          int n = read_int();
-
-          // Collect the arguments
-          vector<MX> args(n);
-          for (int k=0; k<n; ++k) {
-            args[k] = expr();
-          }
-
-          // Perform the operation
-          switch (i) {
-            // case 11: return min(args).scalar(); FIXME // rename?
-            // case 12: return max(args).scalar(); FIXME // rename?
-            // case 54: return sum(args).scalar(); FIXME // rename?
-            // case 59: return count(args).scalar(); FIXME // rename?
-            // case 60: return numberof(args).scalar(); FIXME // rename?
-            // case 61: return numberofs(args).scalar(); FIXME // rename?
-            // case 70: return all(args).scalar(); FIXME // and in AMPL // rename?
-            // case 71: return any(args).scalar(); FIXME // or in AMPL // rename?
-            // case 74: return alldiff(args).scalar(); FIXME // rename?
-            case 54:
-            {
-              MX r = 0;
-              for (vector<MX>::const_iterator it=args.begin();
-              it!=args.end(); ++it) r += *it;
-              return r;
-            }
-
-            default:
-            casadi_error("Unknown n-ary operation: " + str(i));
-          }
+          Operation op;
+          op.op = read_int();
+          op.n = n_args(op.op, op.pl);
+          op.first = stack.size();
+          ops.push_back(op);
           break;
         }
 
-        // Piecewise linear terms, class 4 in Gay2005
-        case 64:
-        casadi_error("Piecewise linear terms not supported");
-        break;
-
-        // If-then-else expressions, class 5 in Gay2005
-        case 35: case 65: case 72:
-        casadi_error("If-then-else expressions not supported");
-        break;
-
         default:
-        casadi_error("Unknown operation: " + str(i));
+        casadi_error("Unknown instruction: " + str(inst) + " at position " + str(pos_));
       }
-      break;
 
-      default:
-       uout() << s_.tellg() << std::endl;
-      casadi_error("Unknown instruction: " + str(inst));
-    }
+      // Apply the operations for which all arguments have been read
+      while (!ops.empty() && stack.size()-ops.back().first==ops.back().n) {
+        const Operation& op = ops.back();
+        T r = apply(op, stack.data()+op.first);
+        stack.resize(op.first);
+        stack.push_back(r);
+        ops.pop_back();
+      }
 
-    // Throw error message
-    casadi_error("Unknown error");
+      // Done if the expression is complete
+      if (ops.empty()) return stack.at(0);
+    }
   }
 
   void NlImporter::F_segment() {
@@ -412,19 +451,20 @@ namespace casadi {
     casadi_error("Suffix values unsupported");
   }
 
-  void NlImporter::V_segment() {
+  template<typename T>
+  void NlImporter::V_segment(Expressions<T>& e) {
     // Read header
     int i = read_int();
     int j = read_int();
     read_int();
 
     // Make sure that v is long enough
-    if (i >= v_.size()) {
-      v_.resize(i+1);
+    if (i >= e.v.size()) {
+      e.v.resize(i+1);
     }
 
     // Initialize element to zero
-    v_.at(i) = 0;
+    T vi = 0;
 
     // Add the linear terms
     for (int jj=0; jj<j; ++jj) {
@@ -433,40 +473,69 @@ namespace casadi {
       double cl = read_double();
 
       // Add to variable definition (assuming it has already been defined)
-      casadi_assert(!v_.at(pl).is_empty(), "Circular dependencies not supported");
-      v_.at(i) += cl*v_.at(pl);
+      casadi_assert(!e.v.at(pl).is_empty(), "Circular dependencies not supported");
+      vi += cl*e.v.at(pl);
     }
 
     // Finally, add the nonlinear term
-    v_.at(i) += expr();
+    e.v.at(i) = vi + expr(e.v);
+  }
+
+  void NlImporter::skip_space() {
+    while (true) {
+      char c = buf_[pos_];
+      if (c==' ' || c=='\n' || c=='\t' || c=='\r') {
+        pos_++;
+      } else if (c=='#') {
+        // Comment until the end of the line
+        while (buf_[pos_]!='\n' && pos_<buf_.size()-1) pos_++;
+      } else {
+        break;
+      }
+    }
+  }
+
+  void NlImporter::assert_available(size_t n) {
+    casadi_assert(pos_+n<buf_.size(), "Unexpected end of file");
   }
 
   int NlImporter::read_int() {
     int i;
     if (binary_) {
-      s_.read(reinterpret_cast<char *>(&i), sizeof(int));
+      assert_available(sizeof(int));
+      memcpy(&i, buf_.data()+pos_, sizeof(int));
+      pos_ += sizeof(int);
     } else {
-      s_ >> i;
+      skip_space();
+      char* end;
+      i = static_cast<int>(strtol(buf_.data()+pos_, &end, 10));
+      casadi_assert(end!=buf_.data()+pos_, "Expected an integer at position " + str(pos_));
+      pos_ = end-buf_.data();
     }
     return i;
   }
 
   char NlImporter::read_char() {
-    char c;
-    if (binary_) {
-      s_.read(&c, 1);
-    } else {
-      s_ >> c;
+    if (!binary_) skip_space();
+    if (pos_+1>=buf_.size()) {
+      eof_ = true;
+      return '\0';
     }
-    return c;
+    return buf_[pos_++];
   }
 
   double NlImporter::read_double() {
     double d;
     if (binary_) {
-      s_.read(reinterpret_cast<char *>(&d), sizeof(double));
+      assert_available(sizeof(double));
+      memcpy(&d, buf_.data()+pos_, sizeof(double));
+      pos_ += sizeof(double);
     } else {
-      s_ >> d;
+      skip_space();
+      char* end;
+      d = strtod(buf_.data()+pos_, &end);
+      casadi_assert(end!=buf_.data()+pos_, "Expected a number at position " + str(pos_));
+      pos_ = end-buf_.data();
     }
     return d;
   }
@@ -474,9 +543,11 @@ namespace casadi {
   short NlImporter::read_short() {
     short d;
     if (binary_) {
-      s_.read(reinterpret_cast<char *>(&d), 2);
+      assert_available(2);
+      memcpy(&d, buf_.data()+pos_, 2);
+      pos_ += 2;
     } else {
-      s_ >> d;
+      d = static_cast<short>(read_int());
     }
     return d;
   }
@@ -484,26 +555,36 @@ namespace casadi {
   long NlImporter::read_long() {
     long d;
     if (binary_) {
-      s_.read(reinterpret_cast<char *>(&d), 4);
+      int32_t i;
+      assert_available(4);
+      memcpy(&i, buf_.data()+pos_, 4);
+      pos_ += 4;
+      d = i;
     } else {
-      s_ >> d;
+      skip_space();
+      char* end;
+      d = strtol(buf_.data()+pos_, &end, 10);
+      casadi_assert(end!=buf_.data()+pos_, "Expected an integer at position " + str(pos_));
+      pos_ = end-buf_.data();
     }
     return d;
   }
 
-  void NlImporter::C_segment() {
+  template<typename T>
+  void NlImporter::C_segment(Expressions<T>& e) {
     // Get the number
     int i = read_int();
 
     // Parse and save expression
-    nlp_.g.at(i) = expr();
+    e.g.at(i) = expr(e.v);
   }
 
   void NlImporter::L_segment() {
     casadi_error("Logical constraint expression unsupported");
   }
 
-  void NlImporter::O_segment() {
+  template<typename T>
+  void NlImporter::O_segment(Expressions<T>& e) {
     // Get the number
     read_int(); // i
 
@@ -512,7 +593,7 @@ namespace casadi {
     sign_ = sigma!=0 ? -1 : 1;
 
     // Parse and save expression
-    nlp_.f += expr();
+    e.f += expr(e.v);
   }
 
   void NlImporter::d_segment() {
@@ -664,7 +745,8 @@ namespace casadi {
     }
   }
 
-  void NlImporter::J_segment() {
+  template<typename T>
+  void NlImporter::J_segment(Expressions<T>& e) {
     // Get constraint number and number of terms
     int i = read_int();
     int k = read_int();
@@ -676,11 +758,12 @@ namespace casadi {
       double c = read_double();
 
       // Add to constraints
-      nlp_.g.at(i) += c*v_.at(j);
+      e.g.at(i) += c*e.v.at(j);
     }
   }
 
-  void NlImporter::G_segment() {
+  template<typename T>
+  void NlImporter::G_segment(Expressions<T>& e) {
     // Get objective number and number of terms
     read_int(); // i
     int k = read_int();
@@ -692,7 +775,7 @@ namespace casadi {
       double c = read_double();
 
       // Add to objective
-      nlp_.f += c*v_.at(j);
+      e.f += c*e.v.at(j);
     }
   }
 
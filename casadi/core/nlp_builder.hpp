@@ -26,7 +26,7 @@
 #ifndef CASADI_NLP_BUILDER_HPP
 #define CASADI_NLP_BUILDER_HPP
 
-#include "mx.hpp"
+#include "function.hpp"
 
 namespace casadi {
 
@@ -68,7 +68,11 @@ namespace casadi {
     std::vector<bool> discrete;
     ///@}
 
-    /// Import an .nl file
+    /** \brief Import an .nl file
+
+        Options: "verbose" (bool), "expand" (bool): build scalar SX expressions,
+        exposed as a single call to an SX Function
+    */
     void import_nl(const std::string& filename, const Dict& opts = Dict());
 
     /// Readable name of the class
@@ -98,21 +102,51 @@ namespace casadi {
     // Destructor
     ~NlImporter();
   private:
+    // Expressions being built, MX or SX
+    template<typename T>
+    struct Expressions {
+      // All variables, including dependent
+      std::vector<T> v;
+      // Objective
+      T f;
+      // Constraints
+      std::vector<T> g;
+    };
+    // Operation whose arguments are being read
+    struct Operation {
+      // Operation code
+      int op;
+      // Number of arguments
+      casadi_int n;
+      // Position of the first argument on the stack
+      casadi_int first;
+      // Slopes and breakpoints of piecewise linear terms
+      std::vector<double> pl;
+    };
     int read_int();
     char read_char();
     double read_double();
     short read_short();
     long read_long();
+    // Skip whitespace and comments (ASCII format)
+    void skip_space();
+    // Make sure that n more bytes can be read
+    void assert_available(size_t n);
     // Reference to the class
     NlpBuilder& nlp_;
     // Options
-    bool verbose_;
+    bool verbose_, expand_;
     // Binary mode
     bool binary_;
-    // File stream
-    std::ifstream s_;
-    // All variables, including dependent
-    std::vector<MX> v_;
+    // Contents of the file, null-terminated
+    std::vector<char> buf_;
+    // Current position in the file
+    size_t pos_;
+    // End of file encountered
+    bool eof_;
+    // Expressions, MX or SX depending on the expand option
+    Expressions<MX> mx_;
+    Expressions<SX> sx_;
     // Number of objectives and constraints
     casadi_int n_var_, n_con_, n_obj_, n_eq_, n_lcon_;
     // nonlinear vars in constraints, objectives, both
@@ -121,21 +155,21 @@ namespace casadi {
     // Number of discrete variables // see JuliaOpt/AmplNLWriter.jl/src/nl_write.jl
     casadi_int nbv_, niv_, nlvbi_, nlvci_, nlvoi_;
     // objective sign
-    MX sign_;
+    double sign_;
     // Parse the file
-    void parse();
+    template<typename T> void parse(Expressions<T>& e);
     // Imported function description
     void F_segment();
     // Suffix values
     void S_segment();
     // Defined variable definition
-    void V_segment();
+    template<typename T> void V_segment(Expressions<T>& e);
     // Algebraic constraint body
-    void C_segment();
+    template<typename T> void C_segment(Expressions<T>& e);
     // Logical constraint expression
     void L_segment();
     // Objective function
-    void O_segment();
+    template<typename T> void O_segment(Expressions<T>& e);
     // Dual initial guess
     void d_segment();
     // Primal initial guess
@@ -147,11 +181,15 @@ namespace casadi {
     // Jacobian row counts
     void k_segment();
     // Linear terms in the constraint function
-    void J_segment();
+    template<typename T> void J_segment(Expressions<T>& e);
     // Linear terms in the objective function
-    void G_segment();
-    /// Read an expression from an NL-file (Polish infix format)
-    MX expr();
+    template<typename T> void G_segment(Expressions<T>& e);
+    /// Read an expression from an NL-file (Polish prefix format)
+    template<typename T> T expr(const std::vector<T>& v);
+    /// Number of arguments of an operation
+    casadi_int n_args(int op, std::vector<double>& pl);
+    /// Apply an operation to its arguments
+    template<typename T> static T apply(const Operation& op, const T* arg);
   };
 #endif // SWIG
 
@@ -24,6 +24,7 @@
 
 
 #include "nlpsol_impl.hpp"
+#include "nlpsol_batch.hpp"
 #include "external.hpp"
 #include "casadi/core/timing.hpp"
 #include "nlp_builder.hpp"
@@ -122,6 +123,13 @@ namespace casadi {
     return Function::create(Nlpsol::instantiate(name, solver, nlp), opts);
   }
 
+  Function nlpsol_batch(const string& name, const Function& solver, casadi_int n,
+                        const Dict& opts) {
+    casadi_assert(solver.is_a("nlpsol"), "'" + solver.name() + "' is not an NLP solver");
+    casadi_assert(n>0, "Number of instances must be positive, got " + str(n));
+    return Function::create(new NlpsolBatch(name, solver, n), opts);
+  }
+
   vector<string> nlpsol_in() {
     vector<string> ret(nlpsol_n_in());
     for (size_t i=0; i<ret.size(); ++i) ret[i]=nlpsol_in(i);
@@ -443,9 +451,14 @@ namespace casadi {
     m->add_stat(name_);
     m->add_stat("callback_fun");
     m->success = false;
+    m->stop = nullptr;
     return 0;
   }
 
+  bool Nlpsol::is_a(const std::string& type, bool recursive) const {
+    return type==shortname() || (recursive && OracleFunction::is_a(type, recursive));
+  }
+
   void Nlpsol::check_inputs(void* mem) const {
     auto m = static_cast<NlpsolMemory*>(mem);
 
@@ -539,6 +552,7 @@ namespace casadi {
 
     // Reset statistics
     for (auto&& s : m->fstats) s.second.reset();
+    for (auto&& s : m->n_cache_hit) s.second = 0;
     m->fstats.at(name_).tic();
 
     // Bounds, given parameter values
@@ -918,6 +932,8 @@ namespace casadi {
   callback(void* mem, const double* x, const double* f, const double* g,
            const double* lam_x, const double* lam_g, const double* lam_p) const {
     auto m = static_cast<NlpsolMemory*>(mem);
+    // Stop requested by another thread?
+    if (m->stop && *m->stop) return 1;
     // Quick return if no callback function
     if (fcallback_.is_null()) return 0;
     // Callback inputs
@@ -82,6 +82,23 @@ namespace casadi {
 #endif // SWIG
   ///@}
 
+  /** \brief Solve a batch of NLPs with the same solver instance
+
+      Creates a function that solves \a n instances of the NLP defined by
+      \a solver, e.g. from different initial guesses (multi-start) or for
+      different parameter values (scenarios). Inputs and outputs are horizontally
+      concatenated as for Function::map. The instances are distributed over a pool
+      of worker threads that share the derivative functions and sparsity patterns
+      of \a solver; only one memory object per thread is used. The statistics of each
+      instance are available through Function::stats.
+
+      \param solver An NLP solver created with nlpsol
+      \param n Number of instances
+      \param opts Options: max_threads, f_target
+  */
+  CASADI_EXPORT Function nlpsol_batch(const std::string& name, const Function& solver,
+                                      casadi_int n, const Dict& opts=Dict());
+
   /** \brief Get input scheme of NLP solvers
   * \if EXPANDED
   * @copydoc scheme_NlpsolInput
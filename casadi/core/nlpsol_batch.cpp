@@ -0,0 +1,236 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+#include "nlpsol_batch.hpp"
+#include "nlpsol_impl.hpp"
+
+#ifdef CASADI_WITH_THREAD
+#ifdef CASADI_WITH_THREAD_MINGW
+#include <mingw.thread.h>
+#else // CASADI_WITH_THREAD_MINGW
+#include <thread>
+#endif // CASADI_WITH_THREAD_MINGW
+#endif // CASADI_WITH_THREAD
+
+using namespace std;
+
+namespace casadi {
+
+  NlpsolBatch::NlpsolBatch(const std::string& name, const Function& f, casadi_int n)
+    : Map(name, f, n) {
+  }
+
+  NlpsolBatch::~NlpsolBatch() {
+    clear_mem();
+  }
+
+  Options NlpsolBatch::options_
+  = {{&FunctionInternal::options_},
+     {{"max_threads",
+       {OT_INT,
+        "Maximum number of worker threads [number of hardware threads]."}},
+      {"f_target",
+       {OT_DOUBLE,
+        "Stop all instances once one has converged to an objective value "
+        "less than or equal to f_target [-inf]."}}
+     }
+  };
+
+  void NlpsolBatch::init(const Dict& opts) {
+    // Call the initialization method of the base class
+    Map::init(opts);
+
+    // Default options
+#ifdef CASADI_WITH_THREAD
+    casadi_int max_threads = std::thread::hardware_concurrency();
+#else // CASADI_WITH_THREAD
+    casadi_int max_threads = 1;
+#endif // CASADI_WITH_THREAD
+    f_target_ = -inf;
+
+    // Read options
+    for (auto&& op : opts) {
+      if (op.first=="max_threads") {
+        max_threads = op.second;
+      } else if (op.first=="f_target") {
+        f_target_ = op.second;
+      }
+    }
+
+#ifndef CASADI_WITH_THREAD
+    if (max_threads>1 && verbose_) {
+      casadi_message("Solving instances in sequence: CasADi was compiled without thread support");
+    }
+    max_threads = 1;
+#endif // CASADI_WITH_THREAD
+
+    // No more threads than instances
+    nthread_ = std::max(casadi_int(1), std::min(n_, max_threads));
+
+    // Work vectors of each thread
+    alloc_arg(f_.sz_arg() * nthread_);
+    alloc_res(f_.sz_res() * nthread_);
+    alloc_w(f_.sz_w() * nthread_);
+    alloc_iw(f_.sz_iw() * nthread_);
+  }
+
+  int NlpsolBatch::init_mem(void* mem) const {
+    auto m = static_cast<NlpsolBatchMemory*>(mem);
+    m->next = 0;
+    m->n_solved = 0;
+    m->stop = false;
+    return 0;
+  }
+
+  int NlpsolBatch::solve_instances(const double** arg, double** res, casadi_int* iw, double* w,
+      casadi_int t, casadi_int ind, NlpsolBatchMemory* m) const {
+    // Work vectors of the thread
+    const double** arg1 = arg + n_in_ + t*f_.sz_arg();
+    double** res1 = res + n_out_ + t*f_.sz_res();
+    iw += t*f_.sz_iw();
+    w += t*f_.sz_w();
+    // Memory object of the solver, can be interrupted by the other threads
+    auto sm = static_cast<NlpsolMemory*>(f_.memory(ind));
+    sm->stop = &m->stop;
+    int flag = 0;
+    try {
+      while (!m->stop) {
+        // Take the next instance
+        casadi_int i = m->next++;
+        if (i>=n_) break;
+        // Input and output buffers
+        for (casadi_int j=0; j<n_in_; ++j) {
+          arg1[j] = arg[j] ? arg[j] + i*f_.nnz_in(j) : nullptr;
+        }
+        for (casadi_int j=0; j<n_out_; ++j) {
+          res1[j] = res[j] ? res[j] + i*f_.nnz_out(j) : nullptr;
+        }
+        // Solve
+        flag = f_(arg1, res1, iw, w, ind);
+        m->stats[i] = f_.stats(ind);
+        m->n_solved++;
+        if (flag) break;
+        // Stop all threads if the target objective has been reached
+        if (sm->success && sm->f<=f_target_) m->stop = true;
+      }
+    } catch (...) {
+      sm->stop = nullptr;
+      m->stop = true;
+      throw;
+    }
+    sm->stop = nullptr;
+    return flag;
+  }
+
+  int NlpsolBatch::eval(const double** arg, double** res, casadi_int* iw, double* w,
+      void* mem) const {
+    auto m = static_cast<NlpsolBatchMemory*>(mem);
+    m->stats.assign(n_, Dict());
+    m->next = 0;
+    m->n_solved = 0;
+    m->stop = false;
+
+    // Return flag
+    int flag = 0;
+#ifdef CASADI_WITH_THREAD
+    if (nthread_>1) {
+      // Checkout one memory object of the solver per thread
+      std::vector< scoped_checkout<Function> > ind; ind.reserve(nthread_);
+      for (casadi_int t=0; t<nthread_; ++t) ind.emplace_back(f_);
+
+      // Return values and exceptions of each thread
+      std::vector<int> ret_values(nthread_, 0);
+      std::vector<std::exception_ptr> ex(nthread_);
+
+      // Spawn threads, each solves instances until none are left
+      std::vector<std::thread> threads;
+      threads.reserve(nthread_);
+      for (casadi_int t=0; t<nthread_; ++t) {
+        threads.emplace_back([&, t]() {
+          try {
+            ret_values[t] = solve_instances(arg, res, iw, w, t, ind[t], m);
+          } catch (...) {
+            ex[t] = std::current_exception();
+          }
+        });
+      }
+
+      // Join threads
+      for (auto&& th : threads) th.join();
+
+      // Propagate errors, in the order of the threads
+      for (auto&& e : ex) if (e) std::rethrow_exception(e);
+      for (int e : ret_values) flag = flag || e;
+    } else {
+      scoped_checkout<Function> ind(f_);
+      flag = solve_instances(arg, res, iw, w, 0, ind, m);
+    }
+#else // CASADI_WITH_THREAD
+    scoped_checkout<Function> ind(f_);
+    flag = solve_instances(arg, res, iw, w, 0, ind, m);
+#endif // CASADI_WITH_THREAD
+
+    // Instances that were skipped after the target objective was reached
+    for (casadi_int i=0; i<n_; ++i) {
+      if (!m->stats[i].empty()) continue;
+      for (casadi_int j=0; j<n_out_; ++j) {
+        if (res[j]) casadi_fill(res[j] + i*f_.nnz_out(j), f_.nnz_out(j), nan);
+      }
+      m->stats[i]["success"] = false;
+      m->stats[i]["return_status"] = "Not_Solved";
+    }
+    return flag;
+  }
+
+  Dict NlpsolBatch::get_stats(void* mem) const {
+    Dict stats = Map::get_stats(mem);
+    auto m = static_cast<NlpsolBatchMemory*>(mem);
+    // Per-instance statistics
+    std::vector<bool> success(n_, false);
+    std::vector<std::string> return_status(n_);
+    std::vector<casadi_int> iter_count(n_, -1);
+    std::vector<double> t_wall(n_, nan);
+    for (casadi_int i=0; i<m->stats.size(); ++i) {
+      const Dict& s = m->stats[i];
+      auto it = s.find("success");
+      if (it!=s.end()) success[i] = it->second;
+      it = s.find("return_status");
+      if (it!=s.end()) return_status[i] = it->second.to_string();
+      it = s.find("iter_count");
+      if (it!=s.end()) iter_count[i] = it->second;
+      it = s.find("t_wall_" + f_.name());
+      if (it!=s.end()) t_wall[i] = it->second;
+    }
+    stats["success"] = success;
+    stats["return_status"] = return_status;
+    stats["iter_count"] = iter_count;
+    stats["t_wall"] = t_wall;
+    stats["n_solved"] = static_cast<casadi_int>(m->n_solved);
+    stats["target_reached"] = static_cast<bool>(m->stop);
+    return stats;
+  }
+
+} // namespace casadi
@@ -0,0 +1,110 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+#ifndef CASADI_NLPSOL_BATCH_HPP
+#define CASADI_NLPSOL_BATCH_HPP
+
+#include "map.hpp"
+#include <atomic>
+
+/// \cond INTERNAL
+
+namespace casadi {
+
+  /** \brief Memory of a batch of NLP solves */
+  struct CASADI_EXPORT NlpsolBatchMemory {
+    // Statistics of each instance
+    std::vector<Dict> stats;
+
+    // Next instance to be solved
+    std::atomic<casadi_int> next;
+
+    // Number of instances solved
+    std::atomic<casadi_int> n_solved;
+
+    // Has the target objective been reached?
+    std::atomic<bool> stop;
+  };
+
+  /** Solve a batch of NLPs on a pool of threads
+      Each worker thread checks out one memory object of the NLP solver and
+      solves instances until all have been taken or the target objective
+      has been reached.
+  */
+  class CASADI_EXPORT NlpsolBatch : public Map {
+  public:
+    // Constructor
+    NlpsolBatch(const std::string& name, const Function& f, casadi_int n);
+
+    /** \brief  Destructor */
+    ~NlpsolBatch() override;
+
+    /** \brief Get type name */
+    std::string class_name() const override {return "NlpsolBatch";}
+
+    ///@{
+    /** \brief Options */
+    static Options options_;
+    const Options& get_options() const override { return options_;}
+    ///@}
+
+    /** \brief  Initialize */
+    void init(const Dict& opts) override;
+
+    /** \brief Create memory block */
+    void* alloc_mem() const override { return new NlpsolBatchMemory();}
+
+    /** \brief Initalize memory block */
+    int init_mem(void* mem) const override;
+
+    /** \brief Free memory block */
+    void free_mem(void *mem) const override { delete static_cast<NlpsolBatchMemory*>(mem);}
+
+    /// Evaluate the function numerically
+    int eval(const double** arg, double** res, casadi_int* iw, double* w, void* mem) const override;
+
+    /// Type of parallellization
+    std::string parallelization() const override { return "thread"; }
+
+    /// Get all statistics
+    Dict get_stats(void* mem) const override;
+
+  protected:
+    // Solve instances on thread t until none are left, using memory object ind of the solver
+    int solve_instances(const double** arg, double** res, casadi_int* iw, double* w,
+                        casadi_int t, casadi_int ind, NlpsolBatchMemory* m) const;
+
+    // Number of worker threads
+    casadi_int nthread_;
+
+    // Stop once an instance has converged with an objective below this value
+    double f_target_;
+  };
+
+} // namespace casadi
+/// \endcond
+
+#endif // CASADI_NLPSOL_BATCH_HPP
@@ -29,6 +29,7 @@
 #include "nlpsol.hpp"
 #include "oracle_function.hpp"
 #include "plugin_interface.hpp"
+#include <atomic>
 
 
 /// \cond INTERNAL
@@ -53,6 +54,9 @@ namespace casadi {
 
     // Success?
     bool success;
+
+    // Stop requested by another thread, cf. nlpsol_batch
+    const std::atomic<bool>* stop;
   };
 
   /** \brief NLP solver storage class
@@ -145,6 +149,9 @@ namespace casadi {
     /** \brief Free memory block */
     void free_mem(void *mem) const override { delete static_cast<NlpsolMemory*>(mem);}
 
+    /** \brief Check if the function is of a particular type */
+    bool is_a(const std::string& type, bool recursive) const override;
+
     /** \brief Check if the inputs correspond to a well-posed problem */
     virtual void check_inputs(void* mem) const;
 
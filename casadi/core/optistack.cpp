@@ -185,6 +185,14 @@ DM Opti::value(const SX& x, const std::vector<MX>& values) const {
   }
 }
 
+std::vector<DM> Opti::values(const std::vector<MX>& x, const std::vector<MX>& values) const {
+  try {
+    return (*this)->values(x, values);
+  } catch (exception& e) {
+    THROW_ERROR("values", e.what());
+  }
+}
+
 Dict Opti::stats() const {
   try {
     return (*this)->stats();
@@ -700,6 +708,24 @@ Opti Opti::copy() const {
   return (*this)->copy();
 }
 
+Function Opti::to_function(const std::string& name,
+    const std::vector<MX>& args, const std::vector<MX>& res,
+    const std::vector<std::string>& name_in,
+    const std::vector<std::string>& name_out,
+    const Dict& opts) {
+  try {
+    return (*this)->to_function(name, args, res, name_in, name_out, opts);
+  } catch (exception& e) {
+    THROW_ERROR("to_function", e.what());
+  }
+}
+
+Function Opti::to_function(const std::string& name,
+    const std::vector<MX>& args, const std::vector<MX>& res,
+    const Dict& opts) {
+  return to_function(name, args, res, {}, {}, opts);
+}
+
 OptiSol::OptiSol(const Opti& opti) : optistack_(opti) {
 }
 
@@ -721,6 +747,10 @@ DM OptiSol::value(const SX& x, const std::vector<MX>& values) const {
   return optistack_.value(x, values);
 }
 
+std::vector<DM> OptiSol::values(const std::vector<MX>& x, const std::vector<MX>& values) const {
+  return optistack_.values(x, values);
+}
+
 std::vector<MX> OptiSol::value_variables() const {
   return optistack_.value_variables();
 }
@@ -208,6 +208,17 @@ public:
   native_DM value(const SX& x, const std::vector<MX>& values=std::vector<MX>()) const;
   /// @}
 
+  /** Obtain values of several expressions at the current value
+  *
+  * Equivalent to calling 'value' on each expression,
+  * but all expressions are evaluated with a single function call
+  *
+  * \param[in] values Optional assignment expressions (e.g. x==3)
+  *            to overrule the current value
+  */
+  std::vector<DM> values(const std::vector<MX>& x,
+    const std::vector<MX>& values=std::vector<MX>()) const;
+
   /** \brief Get statistics
   *
   * nlpsol stats are passed as-is.
@@ -306,6 +317,29 @@ public:
    * */
   Opti copy() const;
 
+  /** \brief Create a CasADi Function from the Opti solver
+   *
+   * The solver and all its derivative functions are constructed once.
+   * Evaluating the Function only performs the numerical solve.
+   *
+   * \param[in] args Opti symbols that become inputs of the Function.
+   *            Parameters are fixed to the input value, variables and duals
+   *            (opti.lam_g) use the input value as initial guess.
+   *            Symbols that are not inputs keep their current initial/parameter value.
+   *            Feeding the solution of a call back as initial guess warm starts the next call.
+   * \param[in] res Expressions to evaluate at the solution
+   * \param[in] opts Options for the Function. Solver options, e.g. 'jit',
+   *            are passed with 'solver'.
+   */
+  Function to_function(const std::string& name,
+      const std::vector<MX>& args, const std::vector<MX>& res,
+      const std::vector<std::string>& name_in,
+      const std::vector<std::string>& name_out,
+      const Dict& opts=Dict());
+  Function to_function(const std::string& name,
+      const std::vector<MX>& args, const std::vector<MX>& res,
+      const Dict& opts=Dict());
+
   /** \brief add user data
   * Add arbitrary data in the form of a dictionary to symbols
   * or constraints
@@ -535,6 +569,17 @@ class CASADI_EXPORT OptiSol : public SWIG_IF_ELSE(PrintableCommon, Printable<Opt
     native_DM value(const SX& x, const std::vector<MX>& values=std::vector<MX>()) const;
     /// @}
 
+    /** Obtain values of several expressions at the current value
+    *
+    * Equivalent to calling 'value' on each expression,
+    * but all expressions are evaluated with a single function call
+    *
+    * \param[in] values Optional assignment expressions (e.g. x==3)
+    *            to overrule the current value
+    */
+    std::vector<DM> values(const std::vector<MX>& x,
+      const std::vector<MX>& values=std::vector<MX>()) const;
+
     /// get assignment expressions for the optimal solution
     std::vector<MX> value_variables() const;
     std::vector<MX> value_parameters() const;
@@ -235,6 +235,7 @@ MX OptiNode::g_lookup(casadi_int i) const {
 
 OptiNode::OptiNode() : count_(0), count_var_(0), count_par_(0), count_dual_(0) {
   f_ = 0;
+  n_solver_reuse_ = 0;
   instance_number_ = instance_count_++;
   user_callback_ = nullptr;
   store_initial_[OPTI_VAR] = {};
@@ -290,6 +291,81 @@ Opti OptiNode::copy() const {
     return Opti::create(new OptiNode(*this));
 }
 
+Function OptiNode::to_function(const std::string& name,
+    const std::vector<MX>& args, const std::vector<MX>& res,
+    const std::vector<std::string>& name_in,
+    const std::vector<std::string>& name_out,
+    const Dict& opts) {
+  if (problem_dirty()) bake();
+
+  // Verify the constraint types
+  for (const auto& g : g_) {
+    casadi_assert(meta_con(g).type!=OPTI_UNKNOWN,
+      "Constraint type unknown. Use ==, >= or <= .");
+    casadi_assert(meta_con(g).type!=OPTI_PSD,
+      "Psd constraints not implemented yet.");
+  }
+
+  // Solver without callbacks, constructed once for all calls of the Function
+  Function solver = solver_construct(false);
+
+  // Symbols of the problem, with the current values as default
+  std::map<VariableType, std::vector<MX> > sym, val;
+  for (VariableType type : {OPTI_VAR, OPTI_PAR, OPTI_DUAL_G}) {
+    sym[type] = active_symvar(type);
+    for (const auto& v : active_values(type)) val[type].push_back(v);
+  }
+
+  // Position of each symbol among the active symbols of its type
+  std::map<MXNode*, casadi_int> active_ind;
+  for (const auto& e : sym) {
+    for (casadi_int i=0; i<e.second.size(); ++i) active_ind[e.second[i].get()] = i;
+  }
+
+  // Replace values by the inputs
+  for (casadi_int k=0; k<args.size(); ++k) {
+    casadi_assert(args[k].is_valid_input(),
+      "Argument " + str(k) + " is not purely symbolic.");
+    for (const auto& prim : args[k].primitives()) {
+      assert_has(prim);
+      auto it = active_ind.find(prim.get());
+      if (it==active_ind.end()) continue; // Not used in the problem
+      val[meta(prim).type].at(it->second) = prim;
+    }
+  }
+
+  // Parameters that are not inputs must have a value
+  for (casadi_int i=0; i<sym[OPTI_PAR].size(); ++i) {
+    const MX& v = val[OPTI_PAR][i];
+    casadi_assert(!v.is_constant() || static_cast<DM>(v).is_regular(),
+      "You have forgotten to assign a value to a parameter ('set_value'), "
+      "or to pass it as an argument:\n" + describe(sym[OPTI_PAR][i], 1));
+  }
+
+  // Bounds for given parameter values
+  MXDict arg;
+  arg["p"] = veccat(val[OPTI_PAR]);
+  MXDict r = bounds_(arg);
+  arg["lbg"] = r["lbg"];
+  arg["ubg"] = r["ubg"];
+  arg["x0"] = veccat(val[OPTI_VAR]);
+  arg["lam_g0"] = veccat(val[OPTI_DUAL_G]);
+
+  // Embed the solver
+  r = solver(arg);
+
+  // Evaluate the requested expressions at the solution
+  Function helper("helper", std::vector<MX>{veccat(sym[OPTI_VAR]), veccat(sym[OPTI_PAR]),
+    veccat(sym[OPTI_DUAL_G])}, res);
+  casadi_assert(!helper.has_free(),
+    "Output expressions may only depend on symbols that appear in the problem. "
+    "Free symbols: " + str(helper.free_mx()) + ".");
+  std::vector<MX> ret = helper(std::vector<MX>{r.at("x"), arg["p"], r.at("lam_g")});
+
+  if (name_in.empty() && name_out.empty()) return Function(name, args, ret, opts);
+  return Function(name, args, ret, name_in, name_out, opts);
+}
+
 void OptiNode::register_dual(MetaCon& c) {
 
   // Prepare metadata
@@ -365,7 +441,15 @@ MX OptiNode::parameter(casadi_int n, casadi_int m, const std::string& attribute)
 
 Dict OptiNode::stats() const {
   assert_solved();
-  return solver_.stats();
+  Dict ret = solver_.stats();
+  ret["n_call_bake"] = bake_stats_.n_call;
+  ret["t_wall_bake"] = bake_stats_.t_wall;
+  ret["t_proc_bake"] = bake_stats_.t_proc;
+  ret["n_call_construct"] = construct_stats_.n_call;
+  ret["t_wall_construct"] = construct_stats_.t_wall;
+  ret["t_proc_construct"] = construct_stats_.t_proc;
+  ret["n_reuse_construct"] = n_solver_reuse_;
+  return ret;
 }
 
 std::string OptiNode::return_status() const {
@@ -557,20 +641,46 @@ std::vector<MX> OptiNode::value_parameters() const {
   return ret;
 }
 
+const std::vector<MX>& OptiNode::g_symvar(const MX& g) {
+  // Only constraints that are new since the last bake need to be traversed
+  auto it = g_symvar_.find(g.get());
+  if (it!=g_symvar_.end()) return it->second.second;
+
+  // Drop constraints that are no longer used if the cache grows too large
+  if (g_symvar_.size()>=max_cache_size_ && g_symvar_.size()>=2*g_.size()) {
+    std::map<MXNode*, std::pair<MX, std::vector<MX> > > used;
+    for (const auto& e : g_) {
+      it = g_symvar_.find(e.get());
+      if (it!=g_symvar_.end()) used.insert(*it);
+    }
+    g_symvar_.swap(used);
+  }
+  std::pair<MX, std::vector<MX> >& r = g_symvar_[g.get()];
+  r.first = g;
+  r.second = symvar(meta_con(g).canon);
+  return r.second;
+}
+
 void OptiNode::bake() {
   casadi_assert(!f_.is_empty() || !g_.empty(),
     "You need to specify at least an objective (y calling 'minimize'), "
     "or a constraint (by calling 'subject_to').");
+  bake_stats_.tic();
 
   symbol_active_.clear();
   symbol_active_.resize(symbols_.size());
 
-  // Gather all expressions
-  MX total_expr = vertcat(f_, veccat(g_));
-
-  // Categorize the symbols appearing in those expressions
-  for (const auto& d : symvar(total_expr))
+  // Categorize the symbols appearing in the objective and constraints
+  if (f_symvar_.first.get()!=f_.get()) {
+    f_symvar_.first = f_;
+    f_symvar_.second = symvar(f_);
+  }
+  for (const auto& d : f_symvar_.second)
     symbol_active_[meta(d).count] = true;
+  for (const auto& g : g_) {
+    for (const auto& d : g_symvar(g))
+      symbol_active_[meta(d).count] = true;
+  }
 
   std::vector<MX> x = active_symvar(OPTI_VAR);
   casadi_int offset = 0;
@@ -629,6 +739,7 @@ void OptiNode::bake() {
 
   bounds_ = Function("bounds", bounds, {"p"}, {"lbg", "ubg"});
   mark_problem_dirty(false);
+  bake_stats_.toc();
 }
 
 void OptiNode::solver(const std::string& solver_name, const Dict& plugin_options,
@@ -637,6 +748,7 @@ void OptiNode::solver(const std::string& solver_name, const Dict& plugin_options
   solver_options_ = plugin_options;
   if (!solver_options.empty())
     solver_options_[solver_name] = solver_options;
+  solver_cache_.clear();
   mark_solver_dirty();
 }
 
@@ -900,6 +1012,43 @@ bool OptiNode::old_callback() const {
   InternalOptiCallback* cb = static_cast<InternalOptiCallback*>(callback_.get());
   return !cb->associated_with(this);
 }
+Function OptiNode::solver_construct(bool callback) {
+  bool with_callback = callback && user_callback_;
+
+  // Without callbacks, the solver of an earlier bake of the same problem can be reused
+  std::vector<MXNode*> key(1, f_.get());
+  for (const auto& g : g_) key.push_back(g.get());
+  auto it = with_callback ? solver_cache_.end() : solver_cache_.find(key);
+  if (it!=solver_cache_.end()) {
+    n_solver_reuse_++;
+    return it->second.second;
+  }
+
+  construct_stats_.tic();
+  Dict opts = solver_options_;
+
+  // Handle callbacks
+  if (with_callback) {
+    callback_ = Function::create(new InternalOptiCallback(*this), Dict());
+    opts["iteration_callback"] = callback_;
+  }
+
+  casadi_assert(solver_name_!="",
+    "You must call 'solver' on the Opti stack to select a solver. "
+    "Suggestion: opti.solver('ipopt')");
+
+  Function solver = nlpsol("solver", solver_name_, nlp_, opts);
+  construct_stats_.toc();
+
+  if (!with_callback) {
+    if (solver_cache_.size()>=max_solver_cache_size_) solver_cache_.clear();
+    std::vector<MX> problem(1, f_);
+    problem.insert(problem.end(), g_.begin(), g_.end());
+    solver_cache_[key] = std::make_pair(problem, solver);
+  }
+  return solver;
+}
+
 // Solve the problem
 OptiSol OptiNode::solve() {
 
@@ -917,19 +1066,7 @@ OptiSol OptiNode::solve() {
   bool solver_update =  solver_dirty() || old_callback() || (user_callback_ && callback_.is_null());
 
   if (solver_update) {
-    Dict opts = solver_options_;
-
-    // Handle callbacks
-    if (user_callback_) {
-      callback_ = Function::create(new InternalOptiCallback(*this), Dict());
-      opts["iteration_callback"] = callback_;
-    }
-
-    casadi_assert(solver_name_!="",
-      "You must call 'solver' on the Opti stack to select a solver. "
-      "Suggestion: opti.solver('ipopt')");
-
-    solver_ = nlpsol("solver", solver_name_, nlp_, opts);
+    solver_ = solver_construct(true);
     mark_solver_dirty(false);
   }
 
@@ -1000,16 +1137,51 @@ bool override_num(const std::map<casadi_int, MX> & temp, std::vector<DM>& num, c
   return false;
 }
 
-DM OptiNode::value(const MX& expr, const std::vector<MX>& values) const {
-  std::vector<MX> x   = symvar(expr, OPTI_VAR);
-  std::vector<MX> p   = symvar(expr, OPTI_PAR);
-  std::vector<MX> lam = symvar(expr, OPTI_DUAL_G);
+const OptiNode::ValueHelper& OptiNode::value_helper(const std::vector<MX>& expr) const {
+  // Expressions are identified by their nodes
+  std::vector<MXNode*> key;
+  key.reserve(expr.size());
+  for (const auto& e : expr) key.push_back(e.get());
+
+  // Reuse evaluator if the expressions were evaluated before
+  auto it = value_cache_.find(key);
+  if (it!=value_cache_.end()) return it->second;
+
+  // Categorize the symbols appearing in the expressions
+  ValueHelper h;
+  h.expr = expr;
+  for (const auto& d : symvar(veccat(expr))) {
+    VariableType type = meta(d).type;
+    if (type==OPTI_VAR) {
+      h.x.push_back(d);
+    } else if (type==OPTI_PAR) {
+      h.p.push_back(d);
+    } else if (type==OPTI_DUAL_G) {
+      h.lam.push_back(d);
+    }
+  }
 
-  Function helper = Function("helper", std::vector<MX>{veccat(x), veccat(p), veccat(lam)}, {expr});
-  if (helper.has_free())
+  h.f = Function("helper", std::vector<MX>{veccat(h.x), veccat(h.p), veccat(h.lam)}, expr);
+  if (h.f.has_free())
     casadi_error("This expression has symbols that are not defined "
       "within Opti using variable/parameter.");
 
+  // Avoid unbounded growth when many different expressions are evaluated
+  if (value_cache_.size()>=max_cache_size_) value_cache_.clear();
+  return value_cache_[key] = h;
+}
+
+DM OptiNode::value(const MX& expr, const std::vector<MX>& values) const {
+  return this->values(std::vector<MX>{expr}, values).at(0);
+}
+
+std::vector<DM> OptiNode::values(const std::vector<MX>& expr,
+    const std::vector<MX>& values) const {
+  const ValueHelper& h = value_helper(expr);
+  const std::vector<MX>& x = h.x;
+  const std::vector<MX>& p = h.p;
+  const std::vector<MX>& lam = h.lam;
+
   std::map<VariableType, std::map<casadi_int, MX> > temp;
   temp[OPTI_DUAL_G] = std::map<casadi_int, MX>();
   for (const auto& v : values) {
@@ -1059,8 +1231,7 @@ DM OptiNode::value(const MX& expr, const std::vector<MX>& values) const {
         describe(e, 1));
   }
 
-  std::vector<DM> arg = helper(std::vector<DM>{veccat(x_num), veccat(p_num), veccat(lam_num)});
-  return arg[0];
+  return h.f(std::vector<DM>{veccat(x_num), veccat(p_num), veccat(lam_num)});
 }
 
 void OptiNode::assert_active_symbol(const MX& m) const {
@@ -1088,19 +1259,17 @@ void OptiNode::set_value(const std::vector<MX>& assignments) {
   }
 }
 
-void OptiNode::set_value_internal(const MX& x, const DM& v) {
-  mark_solved(false);
-  casadi_assert_dev(v.is_regular());
-  if (x.is_symbolic()) {
-    DM& target = store_initial_[meta(x).type][meta(x).i];
-    Slice all;
-    target.set(v, false, all, all);
-    return;
-  }
+const OptiNode::AssignHelper& OptiNode::assign_helper(const MX& x) const {
+  // Reuse mapping if the expression was assigned to before
+  auto it = assign_cache_.find(x.get());
+  if (it!=assign_cache_.end()) return it->second;
+
+  AssignHelper h;
+  h.expr = x;
 
   // Obtain symbolic primitives
-  std::vector<MX> symbols = MX::symvar(x);
-  MX symbols_cat = veccat(symbols);
+  h.symbols = MX::symvar(x);
+  MX symbols_cat = veccat(h.symbols);
 
   std::string failmessage = "You cannot set initial/value of an arbitrary expression. "
     "Use symbols or simple mappings of symbols.";
@@ -1110,48 +1279,74 @@ void OptiNode::set_value_internal(const MX& x, const DM& v) {
 
   // Evaluate jacobian of expr wrt symbols
   Dict opts = {{"compact", true}};
-  Function Jf("Jf", std::vector<MX>{}, std::vector<MX>{jacobian(x, veccat(symbols), opts)});
+  Function Jf("Jf", std::vector<MX>{}, std::vector<MX>{jacobian(x, symbols_cat, opts)});
   DM J = Jf(std::vector<DM>{})[0];
   Sparsity sp_JT = J.T().sparsity();
 
-  Function Ff("Ff", symbols, {x});
-  DM E = Ff(std::vector<DM>(symbols.size(), 0))[0];
-  std::vector<double>& e = E.nonzeros();
+  Function Ff("Ff", h.symbols, {x});
+  DM E = Ff(std::vector<DM>(h.symbols.size(), 0))[0];
+  h.offset = E.nonzeros();
 
-  // Cast the v input into the expected sparsity
-  Slice all;
-  DM value(x.sparsity());
-  value.set(v, false, all, all);
+  // Nonzeros that do not depend on the symbols
+  h.fixed.resize(x.nnz());
+  for (casadi_int i=0;i<x.nnz();++i) {
+    casadi_int nz = sp_JT.colind()[i+1]-sp_JT.colind()[i];
+    casadi_assert(nz<=1, failmessage);
+    h.fixed[i] = nz==0;
+  }
 
   // Purge empty rows
+  Slice all;
   std::vector<casadi_int> filled_rows = sum2(J).get_row();
   J = J(filled_rows, all);
 
   // Get rows and columns of the mapping
-  std::vector<casadi_int> row, col;
-  J.sparsity().get_triplet(row, col);
-  const std::vector<double>& scaling = J.nonzeros();
+  J.sparsity().get_triplet(h.row, h.col);
+  h.scaling = J.nonzeros();
+
+  // Avoid unbounded growth when many different expressions are assigned to
+  if (assign_cache_.size()>=max_cache_size_) assign_cache_.clear();
+  return assign_cache_[x.get()] = h;
+}
+
+void OptiNode::set_value_internal(const MX& x, const DM& v) {
+  mark_solved(false);
+  casadi_assert_dev(v.is_regular());
+  if (x.is_symbolic()) {
+    DM& target = store_initial_[meta(x).type][meta(x).i];
+    Slice all;
+    target.set(v, false, all, all);
+    return;
+  }
+
+  // Mapping from the nonzeros of x to the nonzeros of its symbols
+  const AssignHelper& h = assign_helper(x);
+
+  // Cast the v input into the expected sparsity
+  Slice all;
+  DM value(x.sparsity());
+  value.set(v, false, all, all);
   const std::vector<double>& data_original = value.nonzeros();
 
   std::vector<double> data; data.reserve(value.nnz());
   for (casadi_int i=0;i<value.nnz();++i) {
     double v = data_original[i];
-    casadi_int nz = sp_JT.colind()[i+1]-sp_JT.colind()[i];
-    casadi_assert(nz<=1, failmessage);
-    if (nz) {
+    if (!h.fixed[i]) {
       data.push_back(v);
     } else {
-      casadi_assert(v==e[i], "In initial/value assignment: "
+      casadi_assert(v==h.offset[i], "In initial/value assignment: "
         "inconsistent numerical values. At nonzero " + str(i) + ", lhs has "
-        + str(e[i]) + ", while rhs has " + str(v) + ".");
+        + str(h.offset[i]) + ", while rhs has " + str(v) + ".");
     }
   }
 
   // Contiguous workspace for nonzeros of all involved symbols
-  std::vector<double> temp(symbols_cat.nnz(), casadi::nan);
+  casadi_int n = 0;
+  for (const auto & s : h.symbols) n += s.nnz();
+  std::vector<double> temp(n, casadi::nan);
   for (casadi_int k=0;k<data.size();++k) {
-    double& lhs = temp[col[k]];
-    double rhs = data[row[k]]/scaling[row[k]];
+    double& lhs = temp[h.col[k]];
+    double rhs = data[h.row[k]]/h.scaling[h.row[k]];
     if (std::isnan(lhs)) {
       // Assign in the workspace
       lhs = rhs;
@@ -1161,7 +1356,7 @@ void OptiNode::set_value_internal(const MX& x, const DM& v) {
   }
 
   casadi_int offset = 0;
-  for (const auto & s : symbols) {
+  for (const auto & s : h.symbols) {
     DM& target = store_initial_[meta(s).type][meta(s).i];
     std::vector<double>& data = target.nonzeros();
     // Loop over nonzeros in each symbol
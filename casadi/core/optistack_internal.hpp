@@ -27,6 +27,7 @@
 
 #include "optistack.hpp"
 #include "shared_object_internal.hpp"
+#include "timing.hpp"
 
 namespace casadi {
 
@@ -102,6 +103,8 @@ public:
   /// @{
   /// Obtain value of expression at the current value
   DM value(const MX& x, const std::vector<MX>& values=std::vector<MX>()) const;
+  std::vector<DM> values(const std::vector<MX>& x,
+    const std::vector<MX>& values=std::vector<MX>()) const;
   DM value(const DM& x, const std::vector<MX>& values=std::vector<MX>()) const { return x; }
   DM value(const SX& x, const std::vector<MX>& values=std::vector<MX>()) const {
     return DM::nan(x.sparsity());
@@ -111,6 +114,13 @@ public:
   /// Copy
   Opti copy() const;
 
+  /// Create a CasADi Function from the Opti solver
+  Function to_function(const std::string& name,
+      const std::vector<MX>& args, const std::vector<MX>& res,
+      const std::vector<std::string>& name_in,
+      const std::vector<std::string>& name_out,
+      const Dict& opts);
+
   /// Get statistics
   Dict stats() const;
 
@@ -289,6 +299,67 @@ private:
   /// Set value of symbol
   void set_value_internal(const MX& x, const DM& v);
 
+  /// Evaluator of expressions for 'value', reused for the same expressions
+  struct ValueHelper {
+    /// Expressions (keeps the nodes of the lookup key alive)
+    std::vector<MX> expr;
+    /// Symbols the expressions depend on
+    std::vector<MX> x, p, lam;
+    /// Function from symbols to expressions
+    Function f;
+  };
+
+  /// Linear mapping from symbols to an expression, for 'set_value' and 'set_initial'
+  struct AssignHelper {
+    /// Expression (keeps the node of the lookup key alive)
+    MX expr;
+    /// Symbols in the expression
+    std::vector<MX> symbols;
+    /// Nonzeros of the expression that are fixed, and their values
+    std::vector<bool> fixed;
+    std::vector<double> offset;
+    /// Mapping from nonzeros of the expression to nonzeros of the symbols
+    std::vector<casadi_int> row, col;
+    std::vector<double> scaling;
+  };
+
+  /// Get the (cached) evaluator for expressions
+  const ValueHelper& value_helper(const std::vector<MX>& x) const;
+
+  /// Get the (cached) mapping for an assignment
+  const AssignHelper& assign_helper(const MX& x) const;
+
+  /// Maximum number of cached evaluators and mappings
+  static const casadi_int max_cache_size_ = 1000;
+
+  /// Cached evaluators for 'value'
+  mutable std::map<std::vector<MXNode*>, ValueHelper> value_cache_;
+
+  /// Cached mappings for 'set_value' and 'set_initial'
+  mutable std::map<MXNode*, AssignHelper> assign_cache_;
+
+  /// Symbols in the objective and in each constraint, found in earlier bakes
+  std::pair<MX, std::vector<MX> > f_symvar_;
+  std::map<MXNode*, std::pair<MX, std::vector<MX> > > g_symvar_;
+
+  /// Get the symbols in a constraint
+  const std::vector<MX>& g_symvar(const MX& g);
+
+  /// Construct or reuse the solver for the baked problem
+  Function solver_construct(bool callback);
+
+  /// Maximum number of cached solvers
+  static const casadi_int max_solver_cache_size_ = 16;
+
+  /// Solvers of earlier bakes, keyed by objective and constraints
+  std::map<std::vector<MXNode*>, std::pair<std::vector<MX>, Function> > solver_cache_;
+
+  /// Timings of baking and of solver construction
+  FStats bake_stats_, construct_stats_;
+
+  /// Number of times a solver was reused
+  casadi_int n_solver_reuse_;
+
   /** \brief decompose a chain of inequalities
   *
   * a<=b -> [a,b]
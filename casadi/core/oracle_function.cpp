@@ -51,7 +51,11 @@ namespace casadi {
       {"specific_options",
        {OT_DICT,
         "Options for specific auto-generated functions,"
-        " overwriting the defaults from common_options. Nested dictionary."}}
+        " overwriting the defaults from common_options. Nested dictionary."}},
+      {"cache_size",
+       {OT_INT,
+        "Number of recent evaluations of each auto-generated function to keep,"
+        " repeated evaluations at the same point are then served from memory [0]"}}
     }
   };
 
@@ -59,9 +63,15 @@ namespace casadi {
 
     FunctionInternal::init(opts);
 
+    // Default options
+    cache_size_ = 0;
+
     // Read options
     for (auto&& op : opts) {
-      if (op.first=="common_options") {
+      if (op.first=="cache_size") {
+        cache_size_ = op.second;
+        casadi_assert(cache_size_>=0, "Option 'cache_size' must be nonnegative");
+      } else if (op.first=="common_options") {
         common_options_ = op.second;
       } else if (op.first=="specific_options") {
         specific_options_ = op.second;
@@ -169,15 +179,21 @@ namespace casadi {
     // Number of inputs and outputs
     casadi_int n_in = f.n_in(), n_out = f.n_out();
 
-    // Prepare stats, start timer
-    fstats.tic();
-
     // Input buffers
     if (arg) {
       fill_n(m->arg, n_in, nullptr);
       for (casadi_int i=0; i<n_in; ++i) m->arg[i] = *arg++;
     }
 
+    // Reuse a recent evaluation at the same point, not counted as a call
+    if (cache_size_>0 && cache_lookup(m, fcn, f)) {
+      if (monitored) casadi_message(fcn + " served from cache");
+      return 0;
+    }
+
+    // Prepare stats, start timer
+    fstats.tic();
+
     // Print inputs nonzeros
     if (monitored) {
       std::stringstream s;
@@ -252,6 +268,9 @@ namespace casadi {
       }
     }
 
+    // Remember the evaluation
+    if (cache_size_>0) cache_insert(m, fcn, f);
+
     // Update stats
     fstats.toc();
 
@@ -259,6 +278,83 @@ namespace casadi {
     return 0;
   }
 
+  // Hash of the input nonzeros, missing inputs are zero
+  static size_t cache_hash(const Function& f, const double* const* arg) {
+    size_t h = 0;
+    for (casadi_int i=0; i<f.n_in(); ++i) {
+      casadi_int nnz = f.nnz_in(i);
+      for (casadi_int k=0; k<nnz; ++k) {
+        hash_combine(h, std::hash<double>()(arg[i] ? arg[i][k] : 0.));
+      }
+    }
+    return h;
+  }
+
+  bool OracleFunction::
+  cache_lookup(OracleMemory* m, const std::string& fcn, const Function& f) const {
+    std::list<OracleCacheEntry>& c = m->cache[fcn];
+    if (c.empty()) return false;
+    size_t h = cache_hash(f, m->arg);
+    for (auto e = c.begin(); e!=c.end(); ++e) {
+      if (e->hash!=h) continue;
+      // Compare the inputs
+      bool match = true;
+      const double* in = get_ptr(e->in);
+      for (casadi_int i=0; i<f.n_in() && match; ++i) {
+        casadi_int nnz = f.nnz_in(i);
+        for (casadi_int k=0; k<nnz; ++k) {
+          if (*in++ != (m->arg[i] ? m->arg[i][k] : 0.)) {
+            match = false;
+            break;
+          }
+        }
+      }
+      if (!match) continue;
+      // All requested outputs must be available
+      for (casadi_int i=0; i<f.n_out(); ++i) {
+        if (m->res[i] && !e->has_out[i]) return false;
+      }
+      // Copy the outputs
+      for (casadi_int i=0; i<f.n_out(); ++i) {
+        if (m->res[i]) casadi_copy(get_ptr(e->out[i]), f.nnz_out(i), m->res[i]);
+      }
+      // Most recently used first
+      c.splice(c.begin(), c, e);
+      m->n_cache_hit[fcn]++;
+      return true;
+    }
+    return false;
+  }
+
+  void OracleFunction::
+  cache_insert(OracleMemory* m, const std::string& fcn, const Function& f) const {
+    std::list<OracleCacheEntry>& c = m->cache[fcn];
+    // Reuse the least recently used entry
+    if (c.size() < static_cast<size_t>(cache_size_)) c.emplace_front();
+    else c.splice(c.begin(), c, prev(c.end()));
+    OracleCacheEntry& e = c.front();
+    e.hash = cache_hash(f, m->arg);
+    e.in.clear();
+    for (casadi_int i=0; i<f.n_in(); ++i) {
+      casadi_int nnz = f.nnz_in(i);
+      if (m->arg[i]) {
+        e.in.insert(e.in.end(), m->arg[i], m->arg[i]+nnz);
+      } else {
+        e.in.insert(e.in.end(), nnz, 0.);
+      }
+    }
+    e.out.resize(f.n_out());
+    e.has_out.resize(f.n_out());
+    for (casadi_int i=0; i<f.n_out(); ++i) {
+      e.has_out[i] = m->res[i]!=nullptr;
+      if (m->res[i]) {
+        e.out[i].assign(m->res[i], m->res[i]+f.nnz_out(i));
+      } else {
+        e.out[i].clear();
+      }
+    }
+  }
+
   std::string OracleFunction::
   generate_dependencies(const std::string& fname, const Dict& opts) const {
     CodeGenerator gen(fname, opts);
@@ -323,6 +419,17 @@ namespace casadi {
       stats["t_wall_" +s.first] = s.second.t_wall;
       stats["t_proc_" +s.first] = s.second.t_proc;
     }
+
+    // Cache statistics
+    if (cache_size_>0) {
+      for (auto&& e : all_functions_) {
+        auto it = m->n_cache_hit.find(e.first);
+        casadi_int n_hit = it==m->n_cache_hit.end() ? 0 : it->second;
+        casadi_int n_total = n_hit + m->fstats.at(e.first).n_call;
+        stats["n_cache_hit_" +e.first] = n_hit;
+        stats["cache_hit_rate_" +e.first] = n_total==0 ? 0. : n_hit/static_cast<double>(n_total);
+      }
+    }
     return stats;
   }
 
@@ -28,10 +28,22 @@
 
 #include "function_internal.hpp"
 #include "timing.hpp"
+#include <list>
 
 /// \cond INTERNAL
 namespace casadi {
 
+  /** \brief Cached evaluation of an oracle function */
+  struct CASADI_EXPORT OracleCacheEntry {
+    // Hash of the input nonzeros
+    size_t hash;
+    // Input nonzeros, all inputs concatenated
+    std::vector<double> in;
+    // Output nonzeros, empty if not calculated
+    std::vector<std::vector<double>> out;
+    std::vector<bool> has_out;
+  };
+
   /** \brief Function memory with temporary work vectors */
   struct CASADI_EXPORT OracleMemory {
     // Work vectors
@@ -43,6 +55,12 @@ namespace casadi {
     // Function specific statistics
     std::map<std::string, FStats> fstats;
 
+    // Recent evaluations, most recently used first
+    std::map<std::string, std::list<OracleCacheEntry>> cache;
+
+    // Number of evaluations served from the cache
+    std::map<std::string, casadi_int> n_cache_hit;
+
     // Add a statistic
     void add_stat(const std::string& s) {
       bool added = fstats.insert(std::make_pair(s, FStats())).second;
@@ -72,6 +90,9 @@ namespace casadi {
 
     // All NLP functions
     std::map<std::string, RegFun> all_functions_;
+
+    // Number of cached evaluations per function
+    casadi_int cache_size_;
   public:
     /** \brief  Constructor */
     OracleFunction(const std::string& name, const Function& oracle);
@@ -114,6 +135,12 @@ namespace casadi {
     casadi_int calc_function(OracleMemory* m, const std::string& fcn,
                       const double* const* arg=nullptr) const;
 
+    // Look up an evaluation in the cache, copy the outputs on success
+    bool cache_lookup(OracleMemory* m, const std::string& fcn, const Function& f) const;
+
+    // Add an evaluation to the cache
+    void cache_insert(OracleMemory* m, const std::string& fcn, const Function& f) const;
+
     // Get list of dependency functions
     std::vector<std::string> get_function() const override;
 
@@ -134,7 +134,7 @@ namespace casadi {
     }
 
     // Perform operation inplace
-    g << g.rank1(g.work(arg[0], dep(0).nnz()), sparsity(), g.workel(arg[1]),
+    g << g.rank1(g.work(res[0], nnz()), sparsity(), g.workel(arg[1]),
                          g.work(arg[2], dep(2).nnz()), g.work(arg[3], dep(3).nnz())) << "\n";
   }
 
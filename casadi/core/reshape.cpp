@@ -104,6 +104,11 @@ namespace casadi {
     return reshape(dep(0), sp);
   }
 
+  MX Reshape::get_nzref(const Sparsity& sp, const std::vector<casadi_int>& nz) const {
+    // Reshape does not change the order of the nonzeros
+    return dep()->get_nzref(sp, nz);
+  }
+
   MX Reshape::get_transpose() const {
     // For vectors, reshape is also a transpose
     if (dep().is_vector() && sparsity().is_vector()) {
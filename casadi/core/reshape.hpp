@@ -90,6 +90,9 @@ namespace casadi {
     /// Reshape
     MX get_reshape(const Sparsity& sp) const override;
 
+    /// Get the nonzeros of matrix
+    MX get_nzref(const Sparsity& sp, const std::vector<casadi_int>& nz) const override;
+
     /** \brief Check if two nodes are equivalent up to a given depth */
     bool is_equal(const MXNode* node, casadi_int depth) const override
     { return sameOpAndDeps(node, depth) && sparsity()==node->sparsity();}
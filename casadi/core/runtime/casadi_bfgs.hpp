@@ -47,3 +47,56 @@ void casadi_bfgs_reset(const casadi_int* sp_h, T1* h) {
     }
   }
 }
+
+// SYMBOL "bfgs_block"
+// Partitioned BFGS update of a block-diagonal Hessian approximation: the
+// variables in each block, given by blk[i] for variable i, get their own damped
+// BFGS update. len[w] >= 2*nx + 3*nblk
+template<typename T1>
+void casadi_bfgs_block(const casadi_int* sp_h, T1* h, const casadi_int* blk, casadi_int nblk,
+                       const T1* dx, const T1* glag, const T1* glag_old, T1* w) {
+  // Local variables
+  casadi_int nx, c, k, b;
+  T1 *yk, *qk, *sBs, *sy, *omega;
+  const casadi_int *colind, *row;
+  // Dimension
+  nx = sp_h[0];
+  colind = sp_h+2; row = sp_h+nx+3;
+  // Work vectors
+  yk = w; w += nx;
+  qk = w; w += nx;
+  sBs = w; w += nblk;
+  sy = w; w += nblk;
+  omega = w; w += nblk;
+  // yk = glag - glag_old
+  casadi_copy(glag, nx, yk);
+  casadi_axpy(nx, -1., glag_old, yk);
+  // qk = H*dx
+  casadi_fill(qk, nx, 0.);
+  casadi_mv(h, sp_h, dx, qk, 0);
+  // Curvature in each block
+  casadi_fill(sBs, nblk, 0.);
+  casadi_fill(sy, nblk, 0.);
+  for (c=0; c<nx; ++c) {
+    sBs[blk[c]] += dx[c]*qk[c];
+    sy[blk[c]] += dx[c]*yk[c];
+  }
+  // Powell damping
+  for (b=0; b<nblk; ++b) {
+    omega[b] = sy[b] < 0.2*sBs[b] ? 0.8*sBs[b]/(sBs[b]-sy[b]) : 1;
+    sy[b] = omega[b]*sy[b] + (1-omega[b])*sBs[b];
+  }
+  // yk = omega * yk + (1 - omega) * qk
+  for (c=0; c<nx; ++c) {
+    b = blk[c];
+    yk[c] = omega[b]*yk[c] + (1-omega[b])*qk[c];
+  }
+  // Update H, blocks without a step are left unchanged
+  for (c=0; c<nx; ++c) {
+    b = blk[c];
+    if (sBs[b]<=0) continue;
+    for (k=colind[c]; k<colind[c+1]; ++k) {
+      h[k] += yk[row[k]]*yk[c]/sy[b] - qk[row[k]]*qk[c]/sBs[b];
+    }
+  }
+}
@@ -0,0 +1,562 @@
+// NOLINT(legal/copyright)
+
+// C-REPLACE "fmin" "casadi_fmin"
+// C-REPLACE "fmax" "casadi_fmax"
+// C-REPLACE "std::max" "casadi_max"
+
+// Primal-dual interior point iterations for the QP
+//   minimize 1/2 x'Hx + g'x subject to lbz <= z := [x; Ax] <= ubz
+// The reduced Newton system
+//   [H + diag(D_x), A'; A, diag(D_a)] [dx; dy_a] = rhs
+// is assembled and solved by the caller, which allows any structure of
+// the KKT system to be exploited. casadi_ipqp drives the iterations and
+// returns to the caller whenever the system needs to be factorized or solved.
+
+// SYMBOL "ipqp_task"
+// Requests from casadi_ipqp to its caller
+enum casadi_ipqp_task {
+  // Iterations finished, see the status field
+  IPQP_DONE,
+  // Iteration progress in the message buffer
+  IPQP_PROGRESS,
+  // Factorize the reduced Newton system with diagonal D
+  IPQP_FACTOR,
+  // Solve the factorized system in-place for the vector v
+  IPQP_SOLVE
+};
+
+// SYMBOL "ipqp_next"
+// Where casadi_ipqp resumes
+enum casadi_ipqp_next {
+  IPQP_RESIDUAL,
+  IPQP_CHECK,
+  IPQP_RHS,
+  IPQP_REFINE,
+  IPQP_STEP
+};
+
+// SYMBOL "ipqp_prob"
+template<typename T1>
+struct casadi_ipqp_prob {
+  // Dimensions
+  casadi_int nx, na, nz;
+  // Sparsity patterns
+  const casadi_int *sp_a, *sp_h;
+  // Infinity
+  T1 inf;
+  // Fraction to the boundary
+  T1 tau;
+  // Penalty weight for fixed variables is 1/reg
+  T1 reg;
+  // Maximum number of iterations and of refinement steps per solve
+  casadi_int max_iter, max_refine;
+  // Tolerance on the residuals and the complementarity
+  T1 tol;
+};
+// C-REPLACE "casadi_ipqp_prob<T1>" "struct casadi_ipqp_prob"
+
+// SYMBOL "ipqp_work"
+template<typename T1>
+void casadi_ipqp_work(const casadi_ipqp_prob<T1>* p, casadi_int* sz_iw, casadi_int* sz_w) {
+  // Persistent work vectors
+  *sz_w = 0;
+  *sz_w += p->nz; // z=[xk,gk]
+  *sz_w += p->nz; // lbz
+  *sz_w += p->nz; // ubz
+  *sz_w += p->nz; // y
+  *sz_w += p->nz; // lam_l
+  *sz_w += p->nz; // lam_u
+  *sz_w += p->nz; // s_l
+  *sz_w += p->nz; // s_u
+  *sz_w += p->nz; // c_l
+  *sz_w += p->nz; // c_u
+  *sz_w += p->nx; // rd
+  *sz_w += p->nz; // sigma
+  *sz_w += p->nz; // q
+  *sz_w += p->nz; // D
+  *sz_w += p->nz; // rhs
+  *sz_w += p->nz; // dz
+  *sz_w += p->nz; // dy
+  *sz_w += p->nz; // ds_l
+  *sz_w += p->nz; // ds_u
+  *sz_w += p->nz; // dlam_l
+  *sz_w += p->nz; // dlam_u
+  *sz_w += p->nz; // sol
+  *sz_w += p->nz; // r
+  *sz_iw = p->nz; // type
+}
+
+// SYMBOL "ipqp_data"
+template<typename T1>
+struct casadi_ipqp_data {
+  // Problem structure
+  const casadi_ipqp_prob<T1>* prob;
+  // QP data
+  const T1 *nz_a, *nz_h, *g;
+  // Primal and dual variables, slacks and complementarity targets
+  T1 *z, *lbz, *ubz, *y, *lam_l, *lam_u, *s_l, *s_u, *c_l, *c_u;
+  // Dual residual, Newton system
+  T1 *rd, *sigma, *q, *D, *rhs;
+  // Search direction
+  T1 *dz, *dy, *ds_l, *ds_u, *dlam_l, *dlam_u;
+  // Solution of the Newton system and its residual, vector to be solved for
+  T1 *sol, *r, *v;
+  // Bound type: 0 free, 1 lower, 2 upper, 3 lower and upper, 4 equality
+  casadi_int* type;
+  // Cost
+  T1 f;
+  // Primal and dual error, mean complementarity
+  T1 pr, du, mu;
+  // Step lengths
+  T1 alpha_pr, alpha_du;
+  // Iteration, corrector step, refinement step
+  casadi_int iter, corr, refine;
+  // Complementarity target
+  T1 mu_target;
+  // Resume point
+  int next;
+  // 0: converged, 1: maximum number of iterations reached
+  int status;
+  // Message buffer
+  char msg[160];
+};
+// C-REPLACE "casadi_ipqp_data<T1>" "struct casadi_ipqp_data"
+
+// SYMBOL "ipqp_init"
+template<typename T1>
+void casadi_ipqp_init(casadi_ipqp_data<T1>* d, casadi_int* iw, T1* w) {
+  const casadi_ipqp_prob<T1>* p = d->prob;
+  d->z = w; w += p->nz;
+  d->lbz = w; w += p->nz;
+  d->ubz = w; w += p->nz;
+  d->y = w; w += p->nz;
+  d->lam_l = w; w += p->nz;
+  d->lam_u = w; w += p->nz;
+  d->s_l = w; w += p->nz;
+  d->s_u = w; w += p->nz;
+  d->c_l = w; w += p->nz;
+  d->c_u = w; w += p->nz;
+  d->rd = w; w += p->nx;
+  d->sigma = w; w += p->nz;
+  d->q = w; w += p->nz;
+  d->D = w; w += p->nz;
+  d->rhs = w; w += p->nz;
+  d->dz = w; w += p->nz;
+  d->dy = w; w += p->nz;
+  d->ds_l = w; w += p->nz;
+  d->ds_u = w; w += p->nz;
+  d->dlam_l = w; w += p->nz;
+  d->dlam_u = w; w += p->nz;
+  d->sol = w; w += p->nz;
+  d->r = w; w += p->nz;
+  d->type = iw; iw += p->nz;
+}
+
+// SYMBOL "ipqp_bounds"
+// Pass the bounds on x and on Ax
+template<typename T1>
+void casadi_ipqp_bounds(casadi_ipqp_data<T1>* d, const T1* lbx, const T1* ubx,
+                        const T1* lba, const T1* uba) {
+  const casadi_ipqp_prob<T1>* p = d->prob;
+  casadi_copy(lbx, p->nx, d->lbz);
+  casadi_copy(lba, p->na, d->lbz+p->nx);
+  casadi_copy(ubx, p->nx, d->ubz);
+  casadi_copy(uba, p->na, d->ubz+p->nx);
+}
+
+// SYMBOL "ipqp_reset"
+// Classify the bounds and initialize the iterates, z[:nx] holds the initial guess
+template<typename T1>
+int casadi_ipqp_reset(casadi_ipqp_data<T1>* d) {
+  // Local variables
+  casadi_int i;
+  int has_l, has_u;
+  const casadi_ipqp_prob<T1>* p = d->prob;
+  // Start the iterations
+  d->iter = 0;
+  d->next = IPQP_RESIDUAL;
+  d->msg[0] = '\0';
+  // Calculate z[nx:]
+  casadi_fill(d->z+p->nx, p->na, 0.);
+  casadi_mv(d->nz_a, p->sp_a, d->z, d->z+p->nx, 0);
+  for (i=0; i<p->nz; ++i) {
+    if (d->lbz[i]>d->ubz[i]) return 1;
+    has_l = d->lbz[i]>-p->inf;
+    has_u = d->ubz[i]<p->inf;
+    if (has_l && has_u && d->lbz[i]==d->ubz[i]) {
+      d->type[i] = 4;
+    } else {
+      d->type[i] = has_l + 2*has_u;
+    }
+    // Slacks are moved away from the bounds, unit multipliers
+    d->y[i] = 0;
+    d->s_l[i] = d->s_u[i] = d->lam_l[i] = d->lam_u[i] = 0;
+    if (d->type[i]==1 || d->type[i]==3) {
+      d->s_l[i] = fmax(d->z[i]-d->lbz[i], 1.);
+      d->lam_l[i] = 1;
+    }
+    if (d->type[i]==2 || d->type[i]==3) {
+      d->s_u[i] = fmax(d->ubz[i]-d->z[i], 1.);
+      d->lam_u[i] = 1;
+    }
+  }
+  return 0;
+}
+
+// SYMBOL "ipqp_residual"
+// Cost, dual and primal residuals and mean complementarity at the current iterate
+template<typename T1>
+void casadi_ipqp_residual(casadi_ipqp_data<T1>* d) {
+  // Local variables
+  casadi_int i, n_comp;
+  const casadi_ipqp_prob<T1>* p = d->prob;
+  // Cost
+  d->f = casadi_bilin(d->nz_h, p->sp_h, d->z, d->z)/2. + casadi_dot(p->nx, d->z, d->g);
+  // Multipliers of the inequalities
+  for (i=0; i<p->nz; ++i) {
+    if (d->type[i]!=4) d->y[i] = d->lam_u[i] - d->lam_l[i];
+  }
+  // Gradient of the Lagrangian
+  casadi_copy(d->g, p->nx, d->rd);
+  casadi_mv(d->nz_h, p->sp_h, d->z, d->rd, 0);
+  casadi_mv(d->nz_a, p->sp_a, d->y+p->nx, d->rd, 1);
+  casadi_axpy(p->nx, 1., d->y, d->rd);
+  d->du = casadi_norm_inf(p->nx, d->rd);
+  // Primal infeasibility and complementarity
+  d->pr = 0;
+  d->mu = 0;
+  n_comp = 0;
+  for (i=0; i<p->nz; ++i) {
+    if (d->type[i]==4) {
+      d->pr = fmax(d->pr, fabs(d->z[i]-d->lbz[i]));
+    }
+    if (d->type[i]==1 || d->type[i]==3) {
+      d->pr = fmax(d->pr, fabs(d->z[i]-d->lbz[i]-d->s_l[i]));
+      d->mu += d->s_l[i]*d->lam_l[i];
+      n_comp++;
+    }
+    if (d->type[i]==2 || d->type[i]==3) {
+      d->pr = fmax(d->pr, fabs(d->ubz[i]-d->z[i]-d->s_u[i]));
+      d->mu += d->s_u[i]*d->lam_u[i];
+      n_comp++;
+    }
+  }
+  if (n_comp>0) d->mu /= n_comp;
+}
+
+// SYMBOL "ipqp_diag"
+// Diagonal D of the reduced Newton system
+template<typename T1>
+void casadi_ipqp_diag(casadi_ipqp_data<T1>* d) {
+  // Local variables
+  casadi_int i;
+  const casadi_ipqp_prob<T1>* p = d->prob;
+  for (i=0; i<p->nz; ++i) {
+    d->sigma[i] = 0;
+    if (d->type[i]==1 || d->type[i]==3) d->sigma[i] += d->lam_l[i]/d->s_l[i];
+    if (d->type[i]==2 || d->type[i]==3) d->sigma[i] += d->lam_u[i]/d->s_u[i];
+    if (i<p->nx) {
+      // Fixed variables are kept in place by a penalty
+      d->D[i] = d->type[i]==4 ? 1./p->reg : d->sigma[i];
+    } else if (d->type[i]==4) {
+      // Equality constraint
+      d->D[i] = 0;
+    } else {
+      // Free constraints get a vanishing multiplier
+      d->D[i] = d->type[i]==0 ? -1./p->reg : -1./d->sigma[i];
+    }
+  }
+}
+
+// SYMBOL "ipqp_rhs"
+// Right-hand side of the reduced Newton system for the complementarity target mu,
+// with the second order correction from the last search direction if corr
+template<typename T1>
+void casadi_ipqp_rhs(casadi_ipqp_data<T1>* d, T1 mu, int corr) {
+  // Local variables
+  casadi_int i;
+  T1 r;
+  const casadi_ipqp_prob<T1>* p = d->prob;
+  for (i=0; i<p->nz; ++i) {
+    // Contribution from the inequalities, dy = sigma*dz + q
+    d->q[i] = 0;
+    if (d->type[i]==1 || d->type[i]==3) {
+      d->c_l[i] = corr ? mu - d->ds_l[i]*d->dlam_l[i] : mu;
+      r = d->z[i]-d->lbz[i]-d->s_l[i];
+      d->q[i] -= d->c_l[i]/d->s_l[i] - d->lam_l[i] - d->lam_l[i]/d->s_l[i]*r;
+    }
+    if (d->type[i]==2 || d->type[i]==3) {
+      d->c_u[i] = corr ? mu - d->ds_u[i]*d->dlam_u[i] : mu;
+      r = d->ubz[i]-d->z[i]-d->s_u[i];
+      d->q[i] += d->c_u[i]/d->s_u[i] - d->lam_u[i] - d->lam_u[i]/d->s_u[i]*r;
+    }
+    if (i<p->nx) {
+      d->rhs[i] = -d->rd[i] - d->q[i];
+      if (d->type[i]==4) d->rhs[i] += (d->lbz[i]-d->z[i])/p->reg;
+    } else if (d->type[i]==4) {
+      d->rhs[i] = d->lbz[i]-d->z[i];
+    } else if (d->type[i]==0) {
+      d->rhs[i] = 0;
+    } else {
+      d->rhs[i] = -d->q[i]/d->sigma[i];
+    }
+  }
+}
+
+// SYMBOL "ipqp_kkt"
+// Assemble the reduced Newton system with the diagonal shifted by reg for the
+// variables and by -reg for the constraints, which makes it quasi-definite.
+// sp_kkt must contain H, A, A' and the diagonal, len[w] >= nz
+template<typename T1>
+void casadi_ipqp_kkt(casadi_ipqp_data<T1>* d, const casadi_int* sp_kkt, T1* nz_kkt,
+                     const casadi_int* sp_at, const T1* nz_at, T1 reg, T1* w) {
+  // Local variables
+  casadi_int i, k;
+  const casadi_int *h_colind, *h_row, *a_colind, *a_row, *at_colind, *at_row,
+                   *kkt_colind, *kkt_row;
+  const casadi_ipqp_prob<T1>* p = d->prob;
+  // Extract sparsities
+  a_row = (a_colind = p->sp_a+2) + p->nx + 1;
+  at_row = (at_colind = sp_at+2) + p->na + 1;
+  h_row = (h_colind = p->sp_h+2) + p->nx + 1;
+  kkt_row = (kkt_colind = sp_kkt+2) + p->nz + 1;
+  // Reset w to zero
+  casadi_fill(w, p->nz, 0.);
+  // Loop over columns of the KKT system
+  for (i=0; i<p->nz; ++i) {
+    // Copy column to w
+    if (i<p->nx) {
+      for (k=h_colind[i]; k<h_colind[i+1]; ++k) w[h_row[k]] = d->nz_h[k];
+      for (k=a_colind[i]; k<a_colind[i+1]; ++k) w[p->nx+a_row[k]] = d->nz_a[k];
+      w[i] += d->D[i] + reg;
+    } else {
+      for (k=at_colind[i-p->nx]; k<at_colind[i-p->nx+1]; ++k) w[at_row[k]] = nz_at[k];
+      w[i] = d->D[i] - reg;
+    }
+    // Copy column to KKT, zero out w
+    for (k=kkt_colind[i]; k<kkt_colind[i+1]; ++k) {
+      nz_kkt[k] = w[kkt_row[k]];
+      w[kkt_row[k]] = 0;
+    }
+  }
+}
+
+// SYMBOL "ipqp_inertia"
+// Check that the pivots D of an LDL' factorization P' L D L' P with permutation P,
+// of a system assembled by casadi_ipqp_kkt, are at least reg/2 for the variables
+// and at most -reg/2 for the constraints
+template<typename T1>
+int casadi_ipqp_inertia(casadi_ipqp_data<T1>* d, const T1* D, const casadi_int* p, T1 reg) {
+  // Local variables
+  casadi_int k;
+  for (k=0; k<d->prob->nz; ++k) {
+    if (p[k]<d->prob->nx ? D[k]<reg/2 : D[k]>-reg/2) return 0;
+  }
+  return 1;
+}
+
+// SYMBOL "ipqp_kkt_mv"
+// r <- K*v with K the reduced Newton system
+template<typename T1>
+void casadi_ipqp_kkt_mv(casadi_ipqp_data<T1>* d, const T1* v, T1* r) {
+  // Local variables
+  casadi_int i;
+  const casadi_ipqp_prob<T1>* p = d->prob;
+  for (i=0; i<p->nz; ++i) r[i] = d->D[i]*v[i];
+  casadi_mv(d->nz_h, p->sp_h, v, r, 0);
+  casadi_mv(d->nz_a, p->sp_a, v+p->nx, r, 1);
+  casadi_mv(d->nz_a, p->sp_a, v, r+p->nx, 0);
+}
+
+// SYMBOL "ipqp_step"
+// Complete the search direction from the solution [dx; dy_a] of the reduced
+// Newton system, stored in dz[:nx] and dy[nx:], and get the step lengths
+template<typename T1>
+void casadi_ipqp_step(casadi_ipqp_data<T1>* d) {
+  // Local variables
+  casadi_int i;
+  int act_l, act_u;
+  T1 r;
+  const casadi_ipqp_prob<T1>* p = d->prob;
+  // dz[nx:] = A*dx
+  casadi_fill(d->dz+p->nx, p->na, 0.);
+  casadi_mv(d->nz_a, p->sp_a, d->dz, d->dz+p->nx, 0);
+  // dy[:nx] from the linearized stationarity
+  casadi_fill(d->dy, p->nx, 0.);
+  casadi_mv(d->nz_h, p->sp_h, d->dz, d->dy, 0);
+  casadi_mv(d->nz_a, p->sp_a, d->dy+p->nx, d->dy, 1);
+  for (i=0; i<p->nx; ++i) d->dy[i] = -d->rd[i]-d->dy[i];
+  // Slacks and multipliers of the inequalities, step lengths
+  d->alpha_pr = d->alpha_du = 1.;
+  for (i=0; i<p->nz; ++i) {
+    if (d->type[i]==0 || d->type[i]==4) continue;
+    // Bounds with large multiplier to slack ratio are (nearly) active
+    act_l = (d->type[i]==1 || d->type[i]==3) && d->lam_l[i]>d->s_l[i];
+    act_u = (d->type[i]==2 || d->type[i]==3) && d->lam_u[i]>d->s_u[i];
+    // Bounds that are not the only active one: slack step from dz
+    if ((d->type[i]==1 || d->type[i]==3) && !(act_l && !act_u)) {
+      r = d->z[i]-d->lbz[i]-d->s_l[i];
+      d->ds_l[i] = d->dz[i] + r;
+      d->dlam_l[i] = (d->c_l[i] - d->lam_l[i]*d->ds_l[i])/d->s_l[i] - d->lam_l[i];
+    }
+    if ((d->type[i]==2 || d->type[i]==3) && !(act_u && !act_l)) {
+      r = d->ubz[i]-d->z[i]-d->s_u[i];
+      d->ds_u[i] = -d->dz[i] + r;
+      d->dlam_u[i] = (d->c_u[i] - d->lam_u[i]*d->ds_u[i])/d->s_u[i] - d->lam_u[i];
+    }
+    // A single active bound: multiplier step from dy, which avoids dividing by a small slack
+    if (act_l && !act_u) {
+      d->dlam_l[i] = (d->type[i]==3 ? d->dlam_u[i] : 0) - d->dy[i];
+      d->ds_l[i] = (d->c_l[i] - d->s_l[i]*d->dlam_l[i])/d->lam_l[i] - d->s_l[i];
+    }
+    if (act_u && !act_l) {
+      d->dlam_u[i] = d->dy[i] + (d->type[i]==3 ? d->dlam_l[i] : 0);
+      d->ds_u[i] = (d->c_u[i] - d->s_u[i]*d->dlam_u[i])/d->lam_u[i] - d->s_u[i];
+    }
+    // Fraction to the boundary
+    if (d->type[i]==1 || d->type[i]==3) {
+      if (d->ds_l[i]<0) d->alpha_pr = fmin(d->alpha_pr, -p->tau*d->s_l[i]/d->ds_l[i]);
+      if (d->dlam_l[i]<0) d->alpha_du = fmin(d->alpha_du, -p->tau*d->lam_l[i]/d->dlam_l[i]);
+    }
+    if (d->type[i]==2 || d->type[i]==3) {
+      if (d->ds_u[i]<0) d->alpha_pr = fmin(d->alpha_pr, -p->tau*d->s_u[i]/d->ds_u[i]);
+      if (d->dlam_u[i]<0) d->alpha_du = fmin(d->alpha_du, -p->tau*d->lam_u[i]/d->dlam_u[i]);
+    }
+  }
+}
+
+// SYMBOL "ipqp_mu_trial"
+// Mean complementarity after the step
+template<typename T1>
+T1 casadi_ipqp_mu_trial(casadi_ipqp_data<T1>* d) {
+  // Local variables
+  casadi_int i, n_comp;
+  T1 mu;
+  const casadi_ipqp_prob<T1>* p = d->prob;
+  mu = 0;
+  n_comp = 0;
+  for (i=0; i<p->nz; ++i) {
+    if (d->type[i]==1 || d->type[i]==3) {
+      mu += (d->s_l[i] + d->alpha_pr*d->ds_l[i])*(d->lam_l[i] + d->alpha_du*d->dlam_l[i]);
+      n_comp++;
+    }
+    if (d->type[i]==2 || d->type[i]==3) {
+      mu += (d->s_u[i] + d->alpha_pr*d->ds_u[i])*(d->lam_u[i] + d->alpha_du*d->dlam_u[i]);
+      n_comp++;
+    }
+  }
+  return n_comp>0 ? mu/n_comp : 0;
+}
+
+// SYMBOL "ipqp_update"
+// Take the step
+template<typename T1>
+void casadi_ipqp_update(casadi_ipqp_data<T1>* d) {
+  // Local variables
+  casadi_int i;
+  const casadi_ipqp_prob<T1>* p = d->prob;
+  casadi_axpy(p->nz, d->alpha_pr, d->dz, d->z);
+  casadi_axpy(p->nz, d->alpha_pr, d->ds_l, d->s_l);
+  casadi_axpy(p->nz, d->alpha_pr, d->ds_u, d->s_u);
+  casadi_axpy(p->nz, d->alpha_du, d->dlam_l, d->lam_l);
+  casadi_axpy(p->nz, d->alpha_du, d->dlam_u, d->lam_u);
+  for (i=0; i<p->nz; ++i) {
+    if (d->type[i]==4) d->y[i] += d->alpha_du*d->dy[i];
+  }
+}
+
+// SYMBOL "ipqp"
+// Take the iterations forward until the caller needs to act, see casadi_ipqp_task
+template<typename T1>
+int casadi_ipqp(casadi_ipqp_data<T1>* d) {
+  // Local variables
+  casadi_int i;
+  const casadi_ipqp_prob<T1>* p = d->prob;
+  while (1) {
+    switch (d->next) {
+    case IPQP_RESIDUAL:
+      // Residuals at the current iterate, report progress
+      casadi_ipqp_residual(d);
+      i = 0;
+      if (d->iter % 10 == 0) {
+        i = snprintf(d->msg, sizeof(d->msg), "%5s %9s %9s %9s %9s %9s %9s\n",
+                     "Iter", "fk", "|pr|", "|du|", "mu", "alpha_pr", "alpha_du");
+      }
+      if (d->iter==0) {
+        snprintf(d->msg+i, sizeof(d->msg)-i, "%5d %9.2g %9.2g %9.2g %9.2g %9s %9s\n",
+                 CASADI_CAST(int, d->iter), d->f, d->pr, d->du, d->mu, "-", "-");
+      } else {
+        snprintf(d->msg+i, sizeof(d->msg)-i, "%5d %9.2g %9.2g %9.2g %9.2g %9.2g %9.2g\n",
+                 CASADI_CAST(int, d->iter), d->f, d->pr, d->du, d->mu, d->alpha_pr, d->alpha_du);
+      }
+      d->next = IPQP_CHECK;
+      return IPQP_PROGRESS;
+    case IPQP_CHECK:
+      // Termination
+      if (d->pr<p->tol && d->du<p->tol && d->mu<p->tol) {
+        snprintf(d->msg, sizeof(d->msg), "QP converged\n");
+        d->status = 0;
+        return IPQP_DONE;
+      } else if (d->iter>=p->max_iter) {
+        snprintf(d->msg, sizeof(d->msg), "QP terminated: max iter\n");
+        d->status = 1;
+        return IPQP_DONE;
+      }
+      d->iter++;
+      // Form the Newton system, predictor step next
+      casadi_ipqp_diag(d);
+      d->corr = 0;
+      d->mu_target = d->mu;
+      d->next = IPQP_RHS;
+      return IPQP_FACTOR;
+    case IPQP_RHS:
+      // Predictor or corrector step
+      casadi_ipqp_rhs(d, d->corr ? d->mu_target : 0., d->corr);
+      casadi_copy(d->rhs, p->nz, d->sol);
+      d->refine = 0;
+      d->v = d->sol;
+      d->next = IPQP_REFINE;
+      return IPQP_SOLVE;
+    case IPQP_REFINE:
+      // Iterative refinement
+      if (d->refine>0) casadi_axpy(p->nz, 1., d->r, d->sol);
+      d->next = IPQP_STEP;
+      if (d->refine++ < p->max_refine) {
+        casadi_ipqp_kkt_mv(d, d->sol, d->r);
+        for (i=0; i<p->nz; ++i) d->r[i] = d->rhs[i]-d->r[i];
+        if (casadi_norm_inf(p->nz, d->r)>1e-14*(1+casadi_norm_inf(p->nz, d->rhs))) {
+          d->v = d->r;
+          d->next = IPQP_REFINE;
+          return IPQP_SOLVE;
+        }
+      }
+      break;
+    case IPQP_STEP:
+      // Complete the search direction
+      casadi_copy(d->sol, p->nx, d->dz);
+      casadi_copy(d->sol+p->nx, p->na, d->dy+p->nx);
+      casadi_ipqp_step(d);
+      if (!d->corr) {
+        // Centering parameter from the affine scaling step
+        if (d->mu>0) d->mu_target = d->mu*pow(casadi_ipqp_mu_trial(d)/d->mu, 3);
+        d->corr = 1;
+        d->next = IPQP_RHS;
+      } else {
+        casadi_ipqp_update(d);
+        d->next = IPQP_RESIDUAL;
+      }
+      break;
+    }
+  }
+}
+
+// SYMBOL "ipqp_solution"
+// Get the solution
+template<typename T1>
+void casadi_ipqp_solution(casadi_ipqp_data<T1>* d, T1* f, T1* x, T1* lam_x, T1* lam_a) {
+  const casadi_ipqp_prob<T1>* p = d->prob;
+  casadi_copy(&d->f, 1, f);
+  casadi_copy(d->z, p->nx, x);
+  casadi_copy(d->y, p->nx, lam_x);
+  casadi_copy(d->y+p->nx, p->na, lam_a);
+}
@@ -50,3 +50,42 @@ void casadi_regularize(const casadi_int* sp_h, T1* h, T1 reg) {
     }
   }
 }
+
+// SYMBOL "regularize_block"
+// Shift each diagonal block of a block-diagonal matrix, given by blk[c] for column c,
+// by its Gershgorin lower bound on the eigenvalues, if negative.
+// Returns the largest shift. len[w] >= nblk
+template<typename T1>
+T1 casadi_regularize_block(const casadi_int* sp_h, T1* h, const casadi_int* blk,
+                           casadi_int nblk, T1* w) {
+  // Local variables
+  casadi_int ncol, c, k;
+  T1 center, radius, reg;
+  const casadi_int *colind, *row;
+  // Get sparsity
+  ncol = sp_h[1];
+  colind = sp_h+2; row = sp_h+ncol+3;
+  // Smallest Gershgorin disc of each block, nonpositive
+  casadi_fill(w, nblk, 0.);
+  for (c=0; c<ncol; ++c) {
+    center = 0;
+    radius = 0;
+    for (k=colind[c]; k<colind[c+1]; ++k) {
+      if (row[k]==c) {
+        center = h[k];
+      } else {
+        radius += std::fabs(h[k]);
+      }
+    }
+    w[blk[c]] = std::fmin(w[blk[c]], center - radius);
+  }
+  // Shift diagonal entries
+  reg = 0;
+  for (c=0; c<ncol; ++c) {
+    reg = std::fmax(reg, -w[blk[c]]);
+    for (k=colind[c]; k<colind[c+1]; ++k) {
+      if (row[k]==c) h[k] -= w[blk[c]];
+    }
+  }
+  return reg;
+}
@@ -0,0 +1,183 @@
+// NOLINT(legal/copyright)
+
+// Factorization and solution of a KKT system that is block tridiagonal after
+// reordering into stages, as for the QPs arising in optimal control
+
+// SYMBOL "riccati_prob"
+template<typename T1>
+struct casadi_riccati_prob {
+  // Dimensions
+  casadi_int nx, na, nz;
+  // Sparsity patterns
+  const casadi_int *sp_a, *sp_h;
+  // Number of stages, largest stage
+  casadi_int nb, nmax;
+  // Stage offsets in the stacked ordering
+  const casadi_int* off;
+  // Stacked ordering: stacked index -> KKT index
+  const casadi_int* perm;
+  // Offsets of the diagonal blocks D_k and of the subdiagonal blocks C_k
+  const casadi_int *off_d, *off_c;
+  // Position of nonzeros of H, A and A' in the block storage, -1 if not stored
+  const casadi_int *h_map, *a_map, *at_map;
+  // Smallest allowed pivot
+  T1 reg;
+};
+// C-REPLACE "casadi_riccati_prob<T1>" "struct casadi_riccati_prob"
+
+// SYMBOL "riccati_work"
+template<typename T1>
+void casadi_riccati_work(const casadi_riccati_prob<T1>* p, casadi_int* sz_iw, casadi_int* sz_w) {
+  // Block storage
+  *sz_w = p->off_c[p->nb-1];
+  // Temporary work vectors
+  *sz_w += p->nmax*p->nmax + p->nz + 2*p->nmax;
+  // Pivoting order
+  *sz_iw = p->nz;
+}
+
+// SYMBOL "riccati_ldl"
+// In-place dense LDL' factorization with symmetric diagonal pivoting,
+// pivots with magnitude smaller than reg get the sign of sgn[k]
+template<typename T1>
+void casadi_riccati_ldl(casadi_int n, T1* a, casadi_int* piv, const T1* sgn, T1 reg) {
+  // Local variables
+  casadi_int i, j, k, r;
+  T1 t;
+  for (j=0; j<n; ++j) piv[j] = j;
+  for (j=0; j<n; ++j) {
+    // Largest remaining diagonal entry
+    r = j;
+    for (i=j+1; i<n; ++i) if (fabs(a[i+i*n])>fabs(a[r+r*n])) r = i;
+    if (r!=j) {
+      // Swap rows and columns j and r
+      for (i=0; i<n; ++i) {
+        t = a[i+j*n]; a[i+j*n] = a[i+r*n]; a[i+r*n] = t;
+      }
+      for (i=0; i<n; ++i) {
+        t = a[j+i*n]; a[j+i*n] = a[r+i*n]; a[r+i*n] = t;
+      }
+      k = piv[j]; piv[j] = piv[r]; piv[r] = k;
+    }
+    // Regularize
+    if (fabs(a[j+j*n])<reg) a[j+j*n] = sgn[piv[j]]*reg;
+    // Column of L
+    for (i=j+1; i<n; ++i) a[i+j*n] /= a[j+j*n];
+    // Update trailing block
+    for (k=j+1; k<n; ++k) {
+      t = a[k+j*n]*a[j+j*n];
+      for (i=j+1; i<n; ++i) a[i+k*n] -= a[i+j*n]*t;
+    }
+  }
+}
+
+// SYMBOL "riccati_ldl_solve"
+// Solve in-place with a factorization from casadi_riccati_ldl, len[w] >= n
+template<typename T1>
+void casadi_riccati_ldl_solve(casadi_int n, const T1* a, const casadi_int* piv, T1* x, T1* w) {
+  // Local variables
+  casadi_int i, j;
+  for (j=0; j<n; ++j) w[j] = x[piv[j]];
+  for (j=0; j<n; ++j) {
+    for (i=j+1; i<n; ++i) w[i] -= a[i+j*n]*w[j];
+  }
+  for (j=0; j<n; ++j) w[j] /= a[j+j*n];
+  for (j=n-1; j>=0; --j) {
+    for (i=j+1; i<n; ++i) w[j] -= a[i+j*n]*w[i];
+  }
+  for (j=0; j<n; ++j) x[piv[j]] = w[j];
+}
+
+// SYMBOL "riccati_factorize"
+// Factorize [H + diag(D[:nx]), A'; A, diag(D[nx:])] stage by stage
+template<typename T1>
+void casadi_riccati_factorize(const casadi_riccati_prob<T1>* p, const T1* nz_h, const T1* nz_a,
+                              const T1* D, T1* kkt, casadi_int* piv, T1* w) {
+  // Local variables
+  casadi_int i, j, k, l, n, n1, nnz;
+  T1 *dk, *ck, *wc, *v, *sgn;
+  // Work vectors
+  wc = w; w += p->nmax*p->nmax;
+  v = w; w += p->nmax;
+  sgn = w; w += p->nmax;
+  // Scatter the KKT system into the block storage
+  casadi_fill(kkt, p->off_c[p->nb-1], 0.);
+  nnz = p->sp_h[2+p->sp_h[1]];
+  for (k=0; k<nnz; ++k) if (p->h_map[k]>=0) kkt[p->h_map[k]] += nz_h[k];
+  nnz = p->sp_a[2+p->sp_a[1]];
+  for (k=0; k<nnz; ++k) {
+    if (p->a_map[k]>=0) kkt[p->a_map[k]] += nz_a[k];
+    if (p->at_map[k]>=0) kkt[p->at_map[k]] += nz_a[k];
+  }
+  for (k=0; k<p->nb; ++k) {
+    n = p->off[k+1]-p->off[k];
+    for (l=0; l<n; ++l) kkt[p->off_d[k] + l + l*n] += D[p->perm[p->off[k]+l]];
+  }
+  // Schur complements, S_k = D_k - C_{k-1} S_{k-1}^{-1} C_{k-1}'
+  for (k=0; k<p->nb; ++k) {
+    n = p->off[k+1]-p->off[k];
+    dk = kkt + p->off_d[k];
+    if (k>0) {
+      n1 = p->off[k]-p->off[k-1];
+      ck = kkt + p->off_c[k-1];
+      // wc = S_{k-1}^{-1} C_{k-1}'
+      for (j=0; j<n; ++j) {
+        for (i=0; i<n1; ++i) wc[i+j*n1] = ck[j+i*n];
+        casadi_riccati_ldl_solve(n1, kkt + p->off_d[k-1], piv + p->off[k-1], wc+j*n1, v);
+      }
+      // S_k -= C_{k-1}*wc
+      for (j=0; j<n; ++j) {
+        for (i=0; i<n; ++i) {
+          for (l=0; l<n1; ++l) dk[i+j*n] -= ck[i+l*n]*wc[l+j*n1];
+        }
+      }
+    }
+    // Variables get positive, constraints negative pivots
+    for (l=0; l<n; ++l) sgn[l] = p->perm[p->off[k]+l]<p->nx ? 1 : -1;
+    casadi_riccati_ldl(n, dk, piv + p->off[k], sgn, p->reg);
+  }
+}
+
+// SYMBOL "riccati_solve"
+// Solve the factorized KKT system in-place
+template<typename T1>
+void casadi_riccati_solve(const casadi_riccati_prob<T1>* p, const T1* kkt,
+                          const casadi_int* piv, T1* x, T1* w) {
+  // Local variables
+  casadi_int i, k, l, n, n1;
+  const T1* ck;
+  T1 *xs, *r, *v;
+  // Work vectors
+  w += p->nmax*p->nmax;
+  xs = w; w += p->nz;
+  r = w; w += p->nmax;
+  v = w; w += p->nmax;
+  // Stacked ordering
+  for (i=0; i<p->nz; ++i) xs[i] = x[p->perm[i]];
+  // Forward sweep
+  for (k=0; k<p->nb; ++k) {
+    n = p->off[k+1]-p->off[k];
+    if (k>0) {
+      n1 = p->off[k]-p->off[k-1];
+      ck = kkt + p->off_c[k-1];
+      for (l=0; l<n1; ++l) {
+        for (i=0; i<n; ++i) xs[p->off[k]+i] -= ck[i+l*n]*xs[p->off[k-1]+l];
+      }
+    }
+    casadi_riccati_ldl_solve(n, kkt + p->off_d[k], piv + p->off[k], xs + p->off[k], v);
+  }
+  // Backward sweep
+  for (k=p->nb-2; k>=0; --k) {
+    n = p->off[k+1]-p->off[k];
+    n1 = p->off[k+2]-p->off[k+1];
+    ck = kkt + p->off_c[k];
+    for (l=0; l<n; ++l) {
+      r[l] = 0;
+      for (i=0; i<n1; ++i) r[l] += ck[i+l*n1]*xs[p->off[k+1]+i];
+    }
+    casadi_riccati_ldl_solve(n, kkt + p->off_d[k], piv + p->off[k], r, v);
+    for (l=0; l<n; ++l) xs[p->off[k]+l] -= r[l];
+  }
+  // Back to the KKT ordering
+  for (i=0; i<p->nz; ++i) x[p->perm[i]] = xs[i];
+}
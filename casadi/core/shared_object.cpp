@@ -27,11 +27,32 @@
 #ifdef WITH_EXTRA_CHECKS
 #include "function.hpp"
 #endif // WITH_EXTRA_CHECKS
+#include <cstdint>
 #include <typeinfo>
 
+#ifdef CASADI_WITH_THREAD
+#ifdef CASADI_WITH_THREAD_MINGW
+#include <mingw.mutex.h>
+#else // CASADI_WITH_THREAD_MINGW
+#include <mutex>
+#endif // CASADI_WITH_THREAD_MINGW
+#endif //CASADI_WITH_THREAD
+
 using namespace std;
 namespace casadi {
 
+#ifdef CASADI_WITH_THREAD
+  // Number of mutexes protecting the weak references
+  static const std::size_t n_weak_ref_mutex = 64;
+
+  // Protects a weak reference against concurrent deletion of the object, never destroyed.
+  // Striped by the address of the reference, so that unrelated lookups do not contend
+  static std::mutex& weak_ref_mutex(const void* ref) {
+    static std::mutex* m = new std::mutex[n_weak_ref_mutex];
+    return m[(reinterpret_cast<std::uintptr_t>(ref) / sizeof(WeakRefInternal)) % n_weak_ref_mutex];
+  }
+#endif //CASADI_WITH_THREAD
+
   // Instantiate templates
   template class SparseStorage<WeakRef>;
 
@@ -140,14 +161,32 @@ namespace casadi {
   }
 
   bool WeakRef::alive() const {
-    return !is_null() && (*this)->raw_ != nullptr;
+    if (is_null()) return false;
+#ifdef CASADI_WITH_THREAD
+    std::lock_guard<std::mutex> lock(weak_ref_mutex(get()));
+#endif // CASADI_WITH_THREAD
+    return (*this)->raw_ != nullptr;
   }
 
   SharedObject WeakRef::shared() {
     SharedObject ret;
+#ifdef CASADI_WITH_THREAD
+    if (is_null()) return ret;
+    std::lock_guard<std::mutex> lock(weak_ref_mutex(get()));
+    if ((*this)->raw_ != nullptr) {
+      // Only take ownership if the object is not already being deleted
+      SharedObjectInternal* raw = (*this)->raw_;
+      casadi_int c = raw->count.load();
+      do {
+        if (c==0) return ret;
+      } while (!raw->count.compare_exchange_weak(c, c+1));
+      ret.assign(raw);
+    }
+#else // CASADI_WITH_THREAD
     if (alive()) {
       ret.own((*this)->raw_);
     }
+#endif // CASADI_WITH_THREAD
     return ret;
   }
 
@@ -168,6 +207,9 @@ namespace casadi {
   }
 
   void WeakRef::kill() {
+#ifdef CASADI_WITH_THREAD
+    std::lock_guard<std::mutex> lock(weak_ref_mutex(get()));
+#endif // CASADI_WITH_THREAD
     (*this)->raw_ = nullptr;
   }
 
@@ -243,7 +243,8 @@ namespace casadi {
 
   template<bool Tr>
   size_t Solve<Tr>::sz_w() const {
-    return sparsity().size1();
+    // Also make room for the generated factorization, which must not use the stack
+    return std::max(static_cast<size_t>(sparsity().size1()), linsol_->codegen_sz_w());
   }
 
   template<bool Tr>
@@ -266,7 +267,7 @@ namespace casadi {
       g << g.copy(g.work(arg[0], nnz()), nnz(), "rr") << '\n';
     }
     // Solver specific codegen
-    linsol_->generate(g, "ss", "rr", nrhs, Tr);
+    linsol_->generate(g, "ss", "rr", nrhs, Tr, "w");
   }
 
 } // namespace casadi
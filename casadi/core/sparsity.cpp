@@ -30,6 +30,14 @@
 #include "sparse_storage_impl.hpp"
 #include <climits>
 
+#ifdef CASADI_WITH_THREAD
+#ifdef CASADI_WITH_THREAD_MINGW
+#include <mingw.mutex.h>
+#else // CASADI_WITH_THREAD_MINGW
+#include <mutex>
+#endif // CASADI_WITH_THREAD_MINGW
+#endif //CASADI_WITH_THREAD
+
 #define CASADI_THROW_ERROR(FNAME, WHAT) \
 throw CasadiException("Error in Sparsity::" FNAME " at " + CASADI_WHERE + ":\n"\
   + std::string(WHAT));
@@ -496,9 +504,59 @@ namespace casadi {
     }
   }
 
-  Sparsity::CachingMap& Sparsity::getCache() {
-    static CachingMap ret;
-    return ret;
+  // Number of independent parts of the sparsity pattern cache
+  static const std::size_t n_cache_shards = 16;
+
+#ifdef CASADI_WITH_THREAD
+  // One lock per part of the cache, never destroyed
+  static std::mutex& cache_mutex(std::size_t h) {
+    static std::mutex* m = new std::mutex[n_cache_shards];
+    return m[h % n_cache_shards];
+  }
+#endif //CASADI_WITH_THREAD
+
+  // Smallest number of cache entries that triggers a sweep for deleted patterns
+  static const std::size_t cache_min_sweep = 64;
+
+  namespace {
+    // Part of the sparsity pattern cache
+    struct CacheShard {
+      // Cached patterns
+      Sparsity::CachingMap map;
+      // Number of entries that triggers the next sweep
+      std::size_t sweep_at;
+      // Statistics
+      casadi_int n_hit, n_miss, n_sweep;
+      CacheShard() : sweep_at(cache_min_sweep), n_hit(0), n_miss(0), n_sweep(0) {}
+    };
+
+    CacheShard& cache_shard(std::size_t h) {
+      static CacheShard ret[n_cache_shards];
+      return ret[h % n_cache_shards];
+    }
+  } // namespace
+
+  Sparsity::CachingMap& Sparsity::getCache(std::size_t h) {
+    return cache_shard(h).map;
+  }
+
+  Dict Sparsity::cache_stats() {
+    casadi_int n_hit=0, n_miss=0, n_sweep=0, size=0, n_alive=0;
+    for (std::size_t s=0; s<n_cache_shards; ++s) {
+#ifdef CASADI_WITH_THREAD
+      std::lock_guard<std::mutex> lock(cache_mutex(s));
+#endif //CASADI_WITH_THREAD
+      const CacheShard& shard = cache_shard(s);
+      n_hit += shard.n_hit;
+      n_miss += shard.n_miss;
+      n_sweep += shard.n_sweep;
+      size += shard.map.size();
+      for (auto&& e : shard.map) {
+        if (e.second.alive()) n_alive++;
+      }
+    }
+    return {{"n_hit", n_hit}, {"n_miss", n_miss}, {"n_sweep", n_sweep},
+            {"size", size}, {"n_alive", n_alive}};
   }
 
   const Sparsity& Sparsity::getScalar() {
@@ -848,14 +906,15 @@ namespace casadi {
     // Hash the pattern
     std::size_t h = hash_sparsity(nrow, ncol, colind, row);
 
-    // Get a reference to the cache
-    CachingMap& cache = getCache();
-
-    // Record the current number of buckets (for garbage collection below)
-    casadi_int bucket_count_before = cache.bucket_count();
+    // Get a reference to the part of the cache for the hash
+#ifdef CASADI_WITH_THREAD
+    std::lock_guard<std::mutex> lock(cache_mutex(h));
+#endif //CASADI_WITH_THREAD
+    CacheShard& shard = cache_shard(h);
+    CachingMap& cache = shard.map;
 
     // WORKAROUND, functions do not appear to work when bucket_count==0
-    if (bucket_count_before>0) {
+    if (!cache.empty()) {
 
       // Find the range of patterns equal to the key (normally only zero or one)
       pair<CachingMap::iterator, CachingMap::iterator> eq = cache.equal_range(h);
@@ -866,17 +925,16 @@ namespace casadi {
         // Get a weak reference to the cached sparsity pattern
         WeakRef& wref = i->second;
 
-        // Check if the pattern still exists
-        if (wref.alive()) {
-
-          // Get an owning reference to the cached pattern
-          Sparsity ref = shared_cast<Sparsity>(wref.shared());
+        // Get an owning reference to the cached pattern, if it still exists
+        Sparsity ref = shared_cast<Sparsity>(wref.shared());
+        if (!ref.is_null()) {
 
           // Check if the pattern matches
           if (ref.is_equal(nrow, ncol, colind, row)) {
 
             // Found match!
             own(ref.get());
+            shard.n_hit++;
             return;
 
           } else { // There is a hash rowision (unlikely, but possible)
@@ -889,16 +947,14 @@ namespace casadi {
           CachingMap::iterator j=i;
           j++; // Start at the next matching key
           for (; j!=eq.second; ++j) {
-            if (j->second.alive()) {
-
-              // Recover cached sparsity
-              Sparsity ref = shared_cast<Sparsity>(j->second.shared());
-
-              // Match found if sparsity matches
-              if (ref.is_equal(nrow, ncol, colind, row)) {
-                own(ref.get());
-                return;
-              }
+            // Recover cached sparsity, if it still exists
+            Sparsity ref = shared_cast<Sparsity>(j->second.shared());
+
+            // Match found if sparsity matches
+            if (!ref.is_null() && ref.is_equal(nrow, ncol, colind, row)) {
+              own(ref.get());
+              shard.n_hit++;
+              return;
             }
           }
 
@@ -907,6 +963,7 @@ namespace casadi {
 
           // Cache this pattern
           wref = *this;
+          shard.n_miss++;
 
           // Return
           return;
@@ -919,12 +976,10 @@ namespace casadi {
 
     // Cache this pattern
     cache.insert(std::pair<std::size_t, WeakRef>(h, *this));
+    shard.n_miss++;
 
-    // Garbage collection (currently only supported for unordered_multimap)
-    casadi_int bucket_count_after = cache.bucket_count();
-
-    // We we increased the number of buckets, take time to garbage-collect deleted references
-    if (bucket_count_before!=bucket_count_after) {
+    // Remove references to deleted patterns each time the number of entries has doubled
+    if (cache.size()>=shard.sweep_at) {
       CachingMap::const_iterator i=cache.begin();
       while (i!=cache.end()) {
         if (!i->second.alive()) {
@@ -933,6 +988,8 @@ namespace casadi {
           i++;
         }
       }
+      shard.n_sweep++;
+      shard.sweep_at = std::max(cache_min_sweep, 2*cache.size());
     }
   }
 
@@ -1880,6 +1937,124 @@ namespace casadi {
     return blockcat({{H, J.T()}, {J, B}});
   }
 
+  casadi_int Sparsity::stages(const Sparsity& H, const Sparsity& J,
+                              std::vector<casadi_int>& xperm, std::vector<casadi_int>& xoff,
+                              std::vector<casadi_int>& gperm, std::vector<casadi_int>& goff) {
+    // Consistency check
+    casadi_assert(H.is_square(), "H must be square");
+    casadi_assert(H.size1() == J.size2(), "Dimension mismatch");
+    casadi_int n = J.size2(), m = J.size1();
+
+    // Sparsity patterns
+    const casadi_int *h_colind = H.colind(), *h_row = H.row();
+    const casadi_int *j_colind = J.colind(), *j_row = J.row();
+    Sparsity JT = J.T();
+    const casadi_int *jt_colind = JT.colind(), *jt_row = JT.row();
+
+    // Level of each variable in the current search, -1 if not reached
+    std::vector<casadi_int> level(n, -1);
+    // Has a constraint been expanded
+    std::vector<bool> expanded(m, false);
+    // Variables and constraints reached in the current search
+    std::vector<casadi_int> visited, rows;
+
+    // Breadth-first search from a variable, returns the number of levels.
+    // Variables are coupled through H or by appearing in the same constraint.
+    auto bfs = [&](casadi_int root) {
+      // Undo the previous search in the same component
+      for (casadi_int i : visited) level[i] = -1;
+      for (casadi_int r : rows) expanded[r] = false;
+      visited.clear();
+      rows.clear();
+      level[root] = 0;
+      visited.push_back(root);
+      for (size_t k=0; k<visited.size(); ++k) {
+        casadi_int i = visited[k], next = level[i]+1;
+        for (casadi_int el=h_colind[i]; el<h_colind[i+1]; ++el) {
+          casadi_int j = h_row[el];
+          if (level[j]<0) {
+            level[j] = next;
+            visited.push_back(j);
+          }
+        }
+        for (casadi_int el=j_colind[i]; el<j_colind[i+1]; ++el) {
+          casadi_int r = j_row[el];
+          if (expanded[r]) continue;
+          expanded[r] = true;
+          rows.push_back(r);
+          for (casadi_int el2=jt_colind[r]; el2<jt_colind[r+1]; ++el2) {
+            casadi_int j = jt_row[el2];
+            if (level[j]<0) {
+              level[j] = next;
+              visited.push_back(j);
+            }
+          }
+        }
+      }
+      return level[visited.back()]+1;
+    };
+
+    // Stage of each variable
+    std::vector<casadi_int> stage(n);
+    casadi_int nb = 0;
+    for (casadi_int c=0; c<n; ++c) {
+      // Skip if part of a previous component
+      if (level[c]>=0) continue;
+      visited.clear();
+      rows.clear();
+      // Pseudo-peripheral root: restart from a variable of smallest degree in the
+      // last level for as long as the number of levels increases
+      casadi_int root = c, depth = bfs(root);
+      while (true) {
+        casadi_int cand = -1, cand_deg = 0;
+        for (casadi_int i : visited) {
+          if (level[i]!=depth-1) continue;
+          casadi_int deg = h_colind[i+1]-h_colind[i] + j_colind[i+1]-j_colind[i];
+          if (cand<0 || deg<cand_deg) {
+            cand = i;
+            cand_deg = deg;
+          }
+        }
+        casadi_int cand_depth = bfs(cand);
+        if (cand_depth<=depth) break;
+        root = cand;
+        depth = cand_depth;
+      }
+      // Level structure from the chosen root
+      bfs(root);
+      for (casadi_int i : visited) stage[i] = nb + level[i];
+      nb += depth;
+    }
+    // Constraints without variables end up in the last stage
+    nb = std::max(nb, casadi_int(1));
+
+    // Variables ordered by stage
+    xoff.assign(nb+1, 0);
+    for (casadi_int i=0; i<n; ++i) xoff[stage[i]+1]++;
+    for (casadi_int b=0; b<nb; ++b) xoff[b+1] += xoff[b];
+    xperm.resize(n);
+    std::vector<casadi_int> w(xoff.begin(), xoff.end()-1);
+    for (casadi_int i=0; i<n; ++i) xperm[w[stage[i]]++] = i;
+
+    // Constraints belong to the stage of their first variable
+    std::vector<casadi_int> gstage(m, nb-1);
+    for (casadi_int r=0; r<m; ++r) {
+      if (jt_colind[r]<jt_colind[r+1]) {
+        gstage[r] = stage[jt_row[jt_colind[r]]];
+        for (casadi_int el=jt_colind[r]; el<jt_colind[r+1]; ++el) {
+          gstage[r] = std::min(gstage[r], stage[jt_row[el]]);
+        }
+      }
+    }
+    goff.assign(nb+1, 0);
+    for (casadi_int r=0; r<m; ++r) goff[gstage[r]+1]++;
+    for (casadi_int b=0; b<nb; ++b) goff[b+1] += goff[b];
+    gperm.resize(m);
+    w.assign(goff.begin(), goff.end()-1);
+    for (casadi_int r=0; r<m; ++r) gperm[w[gstage[r]]++] = r;
+    return nb;
+  }
+
   void Sparsity::serialize(std::ostream &stream) const {
     casadi_int size1=this->size1(), size2=this->size2(), nnz=this->nnz();
     const casadi_int *colind = this->colind(), *row = this->row();
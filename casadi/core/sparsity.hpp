@@ -340,6 +340,14 @@ namespace casadi {
     /** Construct instance from info */
     static Sparsity from_info(const Dict& info);
 
+    /** \brief Statistics of the cache of sparsity patterns
+    *
+    * n_hit and n_miss count lookups that did and did not find an existing pattern,
+    * n_sweep the removals of deleted patterns, size the number of entries and
+    * n_alive the number of entries referring to patterns still in use.
+    */
+    static Dict cache_stats();
+
     /** Export sparsity pattern to file
     *
     * Supported formats:
@@ -648,8 +656,8 @@ namespace casadi {
 #ifndef SWIG
     typedef std::unordered_multimap<std::size_t, WeakRef> CachingMap;
 
-    /// Cached sparsity patterns
-    static CachingMap& getCache();
+    /// Cached sparsity patterns, the part of the cache holding hash key h
+    static CachingMap& getCache(std::size_t h);
 
     /// (Dense) scalar
     static const Sparsity& getScalar();
@@ -879,6 +887,31 @@ namespace casadi {
     static Sparsity kkt(const Sparsity& H, const Sparsity& J,
                         bool with_x_diag=true, bool with_lam_g_diag=true);
 
+    /** \brief Detect the stage structure of a KKT system
+     *
+     * Given the sparsity patterns of the Hessian H (n-by-n) and of the constraint
+     * Jacobian J (m-by-n) of a QP or NLP, order the variables and constraints
+     * into stages, such that H only couples variables of the same or adjacent
+     * stages and a constraint only depends on the variables of its own stage
+     * and of the next one. With stage k consisting of the variables
+     * xperm[xoff[k]], ..., xperm[xoff[k+1]-1] followed by the constraints
+     * gperm[goff[k]], ..., gperm[goff[k+1]-1], the KKT system [H, J'; J, 0]
+     * is block tridiagonal.
+     *
+     * For an optimal control problem, the stages typically recovered are
+     * the controls of one interval together with the state at its end,
+     * irrespective of the order in which the variables were given.
+     * The stages are the level sets of a breadth-first search on the coupling
+     * graph of the variables, started from a pseudo-peripheral variable.
+     *
+     * Returns the number of stages
+     */
+    static casadi_int stages(const Sparsity& H, const Sparsity& J,
+                             std::vector<casadi_int>& SWIG_OUTPUT(xperm),
+                             std::vector<casadi_int>& SWIG_OUTPUT(xoff),
+                             std::vector<casadi_int>& SWIG_OUTPUT(gperm),
+                             std::vector<casadi_int>& SWIG_OUTPUT(goff));
+
 #ifndef SWIG
     /** \brief Assign the nonzero entries of one sparsity pattern to the nonzero
      * entries of another sparsity pattern */
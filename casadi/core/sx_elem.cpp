@@ -70,14 +70,23 @@ namespace casadi {
       else if (intval == 1)        node = casadi_limits<SXElem>::one.node;
       else if (intval == 2)        node = casadi_limits<SXElem>::two.node;
       else if (intval == -1)       node = casadi_limits<SXElem>::minus_one.node;
-      else                        node = IntegerSX::create(intval);
-      node->count++;
+      else                        node = nullptr;
+      // Cached constants are returned with the reference count increased
+      if (node) {
+        node->count++;
+      } else {
+        node = IntegerSX::create(intval);
+      }
     } else {
       if (isnan(val))              node = casadi_limits<SXElem>::nan.node;
       else if (isinf(val))         node = val > 0 ? casadi_limits<SXElem>::inf.node :
                                       casadi_limits<SXElem>::minus_inf.node;
-      else                        node = RealtypeSX::create(val);
-      node->count++;
+      else                        node = nullptr;
+      if (node) {
+        node->count++;
+      } else {
+        node = RealtypeSX::create(val);
+      }
     }
   }
 
@@ -110,20 +119,18 @@ namespace casadi {
   }
 
   SXNode* SXElem::assignNoDelete(const SXElem& scalar) {
-    // Return value
-    SXNode* ret = node;
-
     // quick return if the old and new pointers point to the same object
-    if (node == scalar.node) return ret;
+    if (node == scalar.node) return nullptr;
 
-    // decrease the counter but do not delete if this was the last pointer
-    --node->count;
+    // decrease the counter but do not delete if this was the last pointer,
+    // only the decrement that reaches zero may hand out the node
+    SXNode* ret = --node->count == 0 ? node : nullptr;
 
     // save the new pointer
     node = scalar.node;
     node->count++;
 
-    // Return a pointer to the old node
+    // Return a pointer to the old node, if it has no other owners
     return ret;
   }
 
@@ -517,7 +524,7 @@ namespace casadi {
   const SXElem casadi_limits<SXElem>::zero(new ZeroSX(), false);
   // node corresponding to a constant 1
   const SXElem casadi_limits<SXElem>::one(new OneSX(), false);
-  // node corresponding to a constant 2
+  // node corresponding to a constant 2, the reference from create keeps it alive until exit
   const SXElem casadi_limits<SXElem>::two(IntegerSX::create(2), false);
   // node corresponding to a constant -1
   const SXElem casadi_limits<SXElem>::minus_one(new MinusOneSX(), false);
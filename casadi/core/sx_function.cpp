@@ -224,19 +224,22 @@ namespace casadi {
     }
 
     // Stack used to sort the computational graph
-    stack<SXNode*> s;
+    vector<SXNode*> s;
 
     // All nodes
     vector<SXNode*> nodes;
 
+    // Place of each node in the sorted graph
+    NodeMarker<SXNode> place_in_graph;
+
     // Add the list of nodes
     casadi_int ind=0;
     for (auto it = out_.begin(); it != out_.end(); ++it, ++ind) {
       casadi_int nz=0;
       for (auto itc = (*it)->begin(); itc != (*it)->end(); ++itc, ++nz) {
         // Add outputs to the list
-        s.push(itc->get());
-        sort_depth_first(s, nodes);
+        s.push_back(itc->get());
+        sort_depth_first(s, nodes, place_in_graph);
 
         // A null pointer means an output instruction
         nodes.push_back(static_cast<SXNode*>(nullptr));
@@ -247,7 +250,7 @@ namespace casadi {
     // Set the temporary variables to be the corresponding place in the sorted graph
     for (casadi_int i=0; i<nodes.size(); ++i) {
       if (nodes[i]) {
-        nodes[i]->temp = static_cast<int>(i);
+        place_in_graph.set(nodes[i], i);
       }
     }
 
@@ -296,15 +299,15 @@ namespace casadi {
       switch (ae.op) {
       case OP_CONST: // constant
         ae.d = n->to_double();
-        ae.i0 = n->temp;
+        ae.i0 = place_in_graph.get(n);
         break;
       case OP_PARAMETER: // a parameter or input
         symb_loc.push_back(make_pair(algorithm_.size(), n));
-        ae.i0 = n->temp;
+        ae.i0 = place_in_graph.get(n);
         break;
       case OP_OUTPUT: // output instruction
         ae.i0 = curr_oind;
-        ae.i1 = out_[curr_oind]->at(curr_nz)->temp;
+        ae.i1 = place_in_graph.get(out_[curr_oind]->at(curr_nz).get());
         ae.i2 = curr_nz;
 
         // Go to the next nonzero
@@ -322,9 +325,9 @@ namespace casadi {
         }
         break;
       default:       // Unary or binary operation
-        ae.i0 = n->temp;
-        ae.i1 = n->dep(0).get()->temp;
-        ae.i2 = n->dep(1).get()->temp;
+        ae.i0 = place_in_graph.get(n);
+        ae.i1 = place_in_graph.get(n->dep(0).get());
+        ae.i2 = place_in_graph.get(n->dep(1).get());
       }
 
       // Number of dependencies
@@ -406,7 +409,7 @@ namespace casadi {
     // Reset the temporary variables
     for (casadi_int i=0; i<nodes.size(); ++i) {
       if (nodes[i]) {
-        nodes[i]->temp = 0;
+        place_in_graph.reset(nodes[i]);
       }
     }
 
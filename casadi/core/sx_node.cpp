@@ -25,11 +25,131 @@
 
 #include "sx_node.hpp"
 #include <limits>
-#include <stack>
+#include <vector>
+
+#ifdef CASADI_WITH_THREAD
+#ifdef CASADI_WITH_THREAD_MINGW
+#include <mingw.mutex.h>
+#else // CASADI_WITH_THREAD_MINGW
+#include <mutex>
+#endif // CASADI_WITH_THREAD_MINGW
+#define CASADI_SX_POOL_LOCAL thread_local
+#else // CASADI_WITH_THREAD
+#define CASADI_SX_POOL_LOCAL
+#endif //CASADI_WITH_THREAD
 
 using namespace std;
 namespace casadi {
 
+  namespace {
+    // Nodes are pooled in size classes of sx_pool_unit bytes
+    const size_t sx_pool_unit = 16;
+    const size_t sx_pool_nclass = 4;
+
+    // Size of the slabs that the pools are filled from
+    const size_t sx_pool_slab = 1 << 16;
+
+    // Unused element in a pool
+    struct SXPoolNode {
+      SXPoolNode* next;
+    };
+
+    // Free lists, one per size class (and thread)
+    CASADI_SX_POOL_LOCAL SXPoolNode* sx_pool_free[sx_pool_nclass] = {};
+
+    // All allocated slabs, linked through their first element
+    SXPoolNode* sx_pool_slabs = nullptr;
+
+#ifdef CASADI_WITH_THREAD
+    // Free lists of threads that have exited
+    SXPoolNode* sx_pool_orphans[sx_pool_nclass] = {};
+
+    // Protects sx_pool_slabs and sx_pool_orphans, never destroyed
+    std::mutex& sx_pool_mutex() {
+      static std::mutex* m = new std::mutex();
+      return *m;
+    }
+
+    // Hands over the free lists of a thread when it exits
+    struct SXPoolGuard {
+      bool active;
+      SXPoolGuard() : active(false) {}
+      ~SXPoolGuard() {
+        std::lock_guard<std::mutex> lock(sx_pool_mutex());
+        for (size_t c=0; c<sx_pool_nclass; ++c) {
+          SXPoolNode* n = sx_pool_free[c];
+          if (n==nullptr) continue;
+          while (n->next) n = n->next;
+          n->next = sx_pool_orphans[c];
+          sx_pool_orphans[c] = sx_pool_free[c];
+          sx_pool_free[c] = nullptr;
+        }
+      }
+    };
+    thread_local SXPoolGuard sx_pool_guard;
+#endif //CASADI_WITH_THREAD
+
+    // Refill an empty free list
+    void sx_pool_refill(size_t c) {
+      const size_t sz = (c+1)*sx_pool_unit;
+      char* slab;
+      {
+#ifdef CASADI_WITH_THREAD
+        sx_pool_guard.active = true;
+        std::lock_guard<std::mutex> lock(sx_pool_mutex());
+        // Reuse the nodes released by exited threads, if any
+        if (sx_pool_orphans[c]) {
+          sx_pool_free[c] = sx_pool_orphans[c];
+          sx_pool_orphans[c] = nullptr;
+          return;
+        }
+#endif //CASADI_WITH_THREAD
+        // Allocate a new slab, first unit is used for the list of slabs
+        slab = static_cast<char*>(::operator new(sx_pool_slab));
+        SXPoolNode* s = reinterpret_cast<SXPoolNode*>(slab);
+        s->next = sx_pool_slabs;
+        sx_pool_slabs = s;
+      }
+      // Chain the remainder of the slab
+      SXPoolNode* head = nullptr;
+      for (size_t k=(sx_pool_slab-sx_pool_unit)/sz; k-->0; ) {
+        SXPoolNode* n = reinterpret_cast<SXPoolNode*>(slab + sx_pool_unit + k*sz);
+        n->next = head;
+        head = n;
+      }
+      sx_pool_free[c] = head;
+    }
+  } // namespace
+
+  void* SXNode::operator new(std::size_t sz) {
+    // Size class
+    size_t c = (sz + sx_pool_unit - 1)/sx_pool_unit - 1;
+    if (c>=sx_pool_nclass) return ::operator new(sz);
+    // Pop from free list
+    if (sx_pool_free[c]==nullptr) sx_pool_refill(c);
+    SXPoolNode* n = sx_pool_free[c];
+    sx_pool_free[c] = n->next;
+    return n;
+  }
+
+  void SXNode::operator delete(void* ptr, std::size_t sz) {
+    if (ptr==nullptr) return;
+    // Size class
+    size_t c = (sz + sx_pool_unit - 1)/sx_pool_unit - 1;
+    if (c>=sx_pool_nclass) {
+      ::operator delete(ptr);
+      return;
+    }
+#ifdef CASADI_WITH_THREAD
+    // Threads that only free nodes must also hand over their lists on exit
+    if (sx_pool_free[c]==nullptr) sx_pool_guard.active = true;
+#endif //CASADI_WITH_THREAD
+    // Push to free list
+    SXPoolNode* n = static_cast<SXPoolNode*>(ptr);
+    n->next = sx_pool_free[c];
+    sx_pool_free[c] = n;
+  }
+
   SXNode::SXNode() {
     count = 0;
     temp = 0;
@@ -96,96 +216,117 @@ namespace casadi {
   }
 
   void SXNode::can_inline(std::map<const SXNode*, casadi_int>& nodeind) const {
-    // Add or mark node in map
-    std::map<const SXNode*, casadi_int>::iterator it=nodeind.find(this);
-    if (it==nodeind.end()) {
-      // First time encountered, mark inlined
-      nodeind.insert(it, make_pair(this, 0));
-
-      // Handle dependencies with recursion
-      for (casadi_int i=0; i<n_dep(); ++i) {
-        dep(i)->can_inline(nodeind);
+    // Nodes to be visited, without recursion
+    std::vector<const SXNode*> stack(1, this);
+    while (!stack.empty()) {
+      const SXNode* n = stack.back();
+      stack.pop_back();
+      // Add or mark node in map
+      std::map<const SXNode*, casadi_int>::iterator it=nodeind.find(n);
+      if (it==nodeind.end()) {
+        // First time encountered, mark inlined
+        nodeind.insert(it, make_pair(n, 0));
+
+        // Handle dependencies
+        for (casadi_int i=n->n_dep(); i-->0; ) {
+          stack.push_back(n->dep(i).get());
+        }
+      } else if (it->second==0 && n->op()!=OP_PARAMETER) {
+        // Node encountered before, do not inline (except if symbolic primitive)
+        it->second = -1;
       }
-    } else if (it->second==0 && op()!=OP_PARAMETER) {
-      // Node encountered before, do not inline (except if symbolic primitive)
-      it->second = -1;
     }
   }
 
   std::string SXNode::print_compact(std::map<const SXNode*, casadi_int>& nodeind,
                                    std::vector<std::string>& intermed) const {
-    // Get reference to node index
-    casadi_int& ind = nodeind[this];
-
-    // If positive, already in intermediate expressions
-    if (ind>0) {
-      stringstream ss;
-      ss << "@" << ind;
-      return ss.str();
-    }
+    // Node being printed, with the expressions for the dependencies printed so far
+    struct Frame {
+      const SXNode* n;
+      casadi_int next;
+      std::string arg[2];
+    };
 
-    // Get expressions for dependencies
-    std::string arg[2];
-    for (casadi_int i=0; i<n_dep(); ++i) {
-      arg[i] = dep(i)->print_compact(nodeind, intermed);
-    }
+    // Nodes being printed, without recursion
+    std::vector<Frame> stack(1);
+    stack.back().n = this;
+    stack.back().next = 0;
+    std::string s;
+    while (true) {
+      Frame& f = stack.back();
+
+      // Get reference to node index
+      casadi_int& ind = nodeind[f.n];
+
+      if (f.next==0 && ind>0) {
+        // If positive, already in intermediate expressions
+        s = "@" + str(ind);
+      } else if (f.next<f.n->n_dep()) {
+        // Get expression for the next dependency
+        Frame d;
+        d.n = f.n->dep(f.next).get();
+        d.next = 0;
+        stack.push_back(d);
+        continue;
+      } else {
+        // Get expression for this
+        s = f.n->print(f.arg[0], f.arg[1]);
+
+        // Decide what to do with the expression
+        if (ind!=0) {
+          // Add to list of intermediate expressions and return reference
+          intermed.push_back(s);
+          ind = intermed.size(); // For subsequent references
+          s = "@" + str(ind);
+        }
+      }
 
-    // Get expression for this
-    string s = print(arg[0], arg[1]);
-
-    // Decide what to do with the expression
-    if (ind==0) {
-      // Inline expression
-      return s;
-    } else {
-      // Add to list of intermediate expressions and return reference
-      intermed.push_back(s);
-      ind = intermed.size(); // For subsequent references
-      stringstream ss;
-      ss << "@" << ind;
-      return ss.str();
+      // Pass the expression to the parent node
+      stack.pop_back();
+      if (stack.empty()) return s;
+      stack.back().arg[stack.back().next++] = s;
     }
   }
 
   void SXNode::safe_delete(SXNode* n) {
     // Quick return if more owners
-    if (n->count>0) return;
+    if (n==nullptr) return;
     // Delete straight away if it doesn't have any dependencies
     if (!n->n_dep()) {
       delete n;
       return;
     }
     // Stack of expressions to be deleted
-    std::stack<SXNode*> deletion_stack;
+    std::vector<SXNode*> deletion_stack;
     // Add the node to the deletion stack
-    deletion_stack.push(n);
+    deletion_stack.push_back(n);
     // Process stack
     while (!deletion_stack.empty()) {
       // Top element
-      SXNode *t = deletion_stack.top();
+      SXNode *t = deletion_stack.back();
       // Check if the top element has dependencies with dependencies
       bool added_to_stack = false;
       for (casadi_int c2=0; c2<t->n_dep(); ++c2) { // for all dependencies of the dependency
         // Get the node of the dependency of the top element
         // and remove it from the smart pointer
         SXNode *n2 = t->dep(c2).assignNoDelete(casadi_limits<SXElem>::nan);
-        // Check if this is the only reference to the element
-        if (n2->count == 0) {
+        // Check if this was the only reference to the element
+        if (n2) {
           // Check if unary or binary
           if (!n2->n_dep()) {
             // Delete straight away if not binary
             delete n2;
           } else {
             // Add to deletion stack
-            deletion_stack.push(n2);
+            deletion_stack.push_back(n2);
             added_to_stack = true;
           }
         }
       }
       // Delete and pop from stack if nothing added to the stack
       if (!added_to_stack) {
-        delete deletion_stack.top();
-        deletion_stack.pop();
+        delete deletion_stack.back();
+        deletion_stack.pop_back();
       }
     }
   }
@@ -30,6 +30,9 @@
 #include <string>
 #include <sstream>
 #include <math.h>
+#ifdef CASADI_WITH_THREAD
+#include <atomic>
+#endif // CASADI_WITH_THREAD
 
 /** \brief  Scalar expression (which also works as a smart pointer class to this class) */
 #include "sx_elem.hpp"
@@ -54,6 +57,12 @@ namespace casadi {
     /** \brief  destructor  */
     virtual ~SXNode();
 
+    ///@{
+    /** \brief  Allocate nodes from a pool rather than individually */
+    static void* operator new(std::size_t sz);
+    static void operator delete(void* ptr, std::size_t sz);
+    ///@}
+
     ///@{
     /** \brief  check properties of a node */
     virtual bool is_constant() const { return false; }
@@ -118,9 +127,24 @@ namespace casadi {
     // Mark by flipping the sign of the temporary and decreasing by one
     void mark() const;
 
-    /** \brief Non-recursive delete */
+    /** \brief Non-recursive delete of a node returned by SXElem::assignNoDelete */
     static void safe_delete(SXNode* node);
 
+    /** \brief Increase the reference count, unless the node is being deleted */
+    bool count_up_if_alive() {
+#ifdef CASADI_WITH_THREAD
+      unsigned int c = count.load();
+      do {
+        if (c==0) return false;
+      } while (!count.compare_exchange_weak(c, c+1));
+      return true;
+#else // CASADI_WITH_THREAD
+      if (count==0) return false;
+      count++;
+      return true;
+#endif // CASADI_WITH_THREAD
+    }
+
     // Depth when checking equalities
     static casadi_int eq_depth_;
 
@@ -131,7 +155,11 @@ namespace casadi {
     mutable int temp;
 
     // Reference counter -- counts the number of parents of the node
+#ifdef CASADI_WITH_THREAD
+    std::atomic<unsigned int> count;
+#else // CASADI_WITH_THREAD
     unsigned int count;
+#endif // CASADI_WITH_THREAD
 
   };
 
@@ -34,6 +34,17 @@ namespace casadi {
     set_sparsity(x.sparsity().T());
   }
 
+  MX Transpose::get_nzref(const Sparsity& sp, const std::vector<casadi_int>& nz) const {
+    // Nonzero of the argument corresponding to each nonzero of the transpose
+    std::vector<casadi_int> mapping;
+    dep().sparsity().transpose(mapping);
+
+    // Read directly from the argument
+    std::vector<casadi_int> nz_new(nz);
+    for (auto&& i : nz_new) if (i>=0) i = mapping[i];
+    return dep()->get_nzref(sp, nz_new);
+  }
+
   int Transpose::eval(const double** arg, double** res, casadi_int* iw, double* w) const {
     return eval_gen<double>(arg, res, iw, w);
   }
@@ -44,6 +44,32 @@ throw CasadiException("Error in XFunction::" FNAME " for '" + this->name_ + "' "
 
 namespace casadi {
 
+  /** \brief Integer marker for each node visited when sorting a graph
+
+      Without CASADI_WITH_THREAD, the marker is the temporary of the node. With
+      it, markers are kept in a table local to the traversal, so that graphs
+      sharing nodes (e.g. cached constants) can be sorted concurrently.
+      Unmarked nodes have marker zero.
+  */
+  template<typename NodeType>
+  class NodeMarker {
+  public:
+#ifdef CASADI_WITH_THREAD
+    casadi_int get(const NodeType* n) const {
+      auto it = m_.find(n);
+      return it==m_.end() ? 0 : it->second;
+    }
+    void set(const NodeType* n, casadi_int v) { m_[n] = v;}
+    void reset(const NodeType* n) {}
+  private:
+    std::unordered_map<const NodeType*, casadi_int> m_;
+#else // CASADI_WITH_THREAD
+    casadi_int get(const NodeType* n) const { return n->temp;}
+    void set(const NodeType* n, casadi_int v) { n->temp = v;}
+    void reset(const NodeType* n) { n->temp = 0;}
+#endif // CASADI_WITH_THREAD
+  };
+
   /** \brief  Internal node class for the base class of SXFunction and MXFunction
       (lacks a public counterpart)
       The design of the class uses the curiously recurring template pattern (CRTP) idiom
@@ -74,7 +100,8 @@ namespace casadi {
     ///@}
 
     /** \brief  Topological sorting of the nodes based on Depth-First Search (DFS) */
-    static void sort_depth_first(std::stack<NodeType*>& s, std::vector<NodeType*>& nodes);
+    static void sort_depth_first(std::vector<NodeType*>& s, std::vector<NodeType*>& nodes,
+                                 NodeMarker<NodeType>& m);
 
     /** \brief  Construct a complete Jacobian by compression */
     MatType jac(casadi_int iind, casadi_int oind, const Dict& opts) const;
@@ -263,29 +290,30 @@ namespace casadi {
 
   template<typename DerivedType, typename MatType, typename NodeType>
   void XFunction<DerivedType, MatType, NodeType>::sort_depth_first(
-      std::stack<NodeType*>& s, std::vector<NodeType*>& nodes) {
+      std::vector<NodeType*>& s, std::vector<NodeType*>& nodes, NodeMarker<NodeType>& m) {
     while (!s.empty()) {
       // Get the topmost element
-      NodeType* t = s.top();
+      NodeType* t = s.back();
       // If the last element on the stack has not yet been added
-      if (t && t->temp>=0) {
+      if (t && m.get(t)>=0) {
         // Get the index of the next dependency
-        casadi_int next_dep = t->temp++;
+        casadi_int next_dep = m.get(t);
+        m.set(t, next_dep+1);
         // If there is any dependency which has not yet been added
         if (next_dep < t->n_dep()) {
           // Add dependency to stack
-          s.push(static_cast<NodeType*>(t->dep(next_dep).get()));
+          s.push_back(static_cast<NodeType*>(t->dep(next_dep).get()));
         } else {
           // if no dependencies need to be added, we can add the node to the algorithm
           nodes.push_back(t);
           // Mark the node as found
-          t->temp = -1;
+          m.set(t, -1);
           // Remove from stack
-          s.pop();
+          s.pop_back();
         }
       } else {
         // If the last element on the stack has already been added
-        s.pop();
+        s.pop_back();
       }
     }
   }
@@ -0,0 +1,285 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+#include "xml_reader.hpp"
+#include "casadi_misc.hpp"
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+
+using namespace std;
+namespace casadi {
+
+  XmlReader::XmlReader(const string& filename)
+    : file_(filename, ios::binary), is_start_(false), self_closing_(false),
+      pending_end_(false), depth_(-1) {
+    casadi_assert(file_.good(), "Could not open " + filename);
+    buf_ = file_.rdbuf();
+  }
+
+  bool XmlReader::next() {
+    // End tag of a self-closing element
+    if (pending_end_) {
+      pending_end_ = false;
+      close(node_.name());
+      return true;
+    }
+    while (true) {
+      switch (read_token()) {
+      case TOKEN_START:
+        open();
+        return true;
+      case TOKEN_END:
+        close(name_);
+        return true;
+      case TOKEN_TEXT:
+        continue;
+      case TOKEN_EOF:
+        casadi_assert(open_.empty(), "Unexpected end of document in <" + open_.back() + ">");
+        return false;
+      }
+    }
+  }
+
+  XmlNode XmlReader::read_node() {
+    casadi_assert(is_start_, "XmlReader::read_node: Not at a start tag");
+
+    // Elements being read, innermost last
+    vector<XmlNode> stack(1, node_);
+    while (true) {
+      if (pending_end_) {
+        pending_end_ = false;
+        close(stack.back().name());
+      } else {
+        switch (read_token()) {
+        case TOKEN_START:
+          open();
+          stack.push_back(node_);
+          continue;
+        case TOKEN_END:
+          close(name_);
+          break;
+        case TOKEN_TEXT:
+          {
+            // Strip leading and trailing white space
+            size_t b = text_.find_first_not_of(" \t\r\n");
+            if (b==string::npos) continue;
+            size_t e = text_.find_last_not_of(" \t\r\n");
+            stack.back().text_ += text_.substr(b, e-b+1);
+          }
+          continue;
+        case TOKEN_EOF:
+          casadi_error("Unexpected end of document in <" + stack.back().name() + ">");
+        }
+      }
+
+      // Attach the completed element to its parent
+      if (stack.size()==1) break;
+      XmlNode& parent = stack[stack.size()-2];
+      parent.child_indices_[stack.back().name()] = parent.children_.size();
+      parent.children_.push_back(XmlNode());
+      swap(parent.children_.back(), stack.back());
+      stack.pop_back();
+    }
+    return stack.front();
+  }
+
+  void XmlReader::open() {
+    is_start_ = true;
+    depth_ = open_.size();
+    open_.push_back(node_.name());
+    pending_end_ = self_closing_;
+  }
+
+  void XmlReader::close(const string& name) {
+    casadi_assert(!open_.empty() && open_.back()==name,
+      "Unexpected end tag </" + name + ">");
+    open_.pop_back();
+    is_start_ = false;
+    depth_ = open_.size();
+  }
+
+  XmlReader::Token XmlReader::read_token() {
+    while (true) {
+      // Text up to the next tag
+      int c = buf_->sgetc();
+      if (c==EOF) return TOKEN_EOF;
+      if (c!='<') {
+        text_.clear();
+        append_text(text_, '<');
+        if (text_.find_first_not_of(" \t\r\n")!=string::npos) return TOKEN_TEXT;
+        continue;
+      }
+      buf_->sbumpc();
+      c = buf_->sgetc();
+      if (c=='?') {
+        // Processing instruction or XML declaration
+        skip_past("?>");
+      } else if (c=='!') {
+        buf_->sbumpc();
+        if (buf_->sgetc()=='-') {
+          // Comment
+          skip_past("-->");
+        } else if (buf_->sgetc()=='[') {
+          // CDATA section, read verbatim
+          skip_past("[CDATA[");
+          text_.clear();
+          while ((c = buf_->sbumpc())!=EOF) {
+            text_.push_back(static_cast<char>(c));
+            size_t n = text_.size();
+            if (n>=3 && text_.compare(n-3, 3, "]]>")==0) {
+              text_.resize(n-3);
+              return TOKEN_TEXT;
+            }
+          }
+          casadi_error("Unterminated CDATA section");
+        } else {
+          // Document type declaration
+          skip_past(">");
+        }
+      } else if (c=='/') {
+        // End tag
+        buf_->sbumpc();
+        read_name(name_);
+        skip_space();
+        expect('>');
+        return TOKEN_END;
+      } else {
+        // Start tag
+        read_name(name_);
+        node_ = XmlNode();
+        node_.setName(name_);
+        self_closing_ = false;
+        while (true) {
+          skip_space();
+          c = buf_->sgetc();
+          if (c=='/') {
+            buf_->sbumpc();
+            expect('>');
+            self_closing_ = true;
+            break;
+          } else if (c=='>') {
+            buf_->sbumpc();
+            break;
+          }
+          // Attribute
+          read_name(att_name_);
+          skip_space();
+          expect('=');
+          skip_space();
+          int q = buf_->sbumpc();
+          casadi_assert(q=='"' || q=='\'',
+            "Expected quoted value for attribute " + att_name_ + " of <" + name_ + ">");
+          att_val_.clear();
+          append_text(att_val_, q);
+          expect(static_cast<char>(q));
+          node_.set_attribute(att_name_, att_val_);
+        }
+        return TOKEN_START;
+      }
+    }
+  }
+
+  void XmlReader::read_name(string& s) {
+    s.clear();
+    int c;
+    while ((c = buf_->sgetc())!=EOF && !isspace(c) && c!='>' && c!='/' && c!='=') {
+      s.push_back(static_cast<char>(c));
+      buf_->sbumpc();
+    }
+    casadi_assert(!s.empty(), "Expected a name in XML document");
+  }
+
+  void XmlReader::skip_space() {
+    int c;
+    while ((c = buf_->sgetc())!=EOF && isspace(c)) buf_->sbumpc();
+  }
+
+  void XmlReader::skip_past(const char* term) {
+    // Compare the last characters read with the terminating string
+    size_t n = strlen(term);
+    string last;
+    int c;
+    while ((c = buf_->sbumpc())!=EOF) {
+      last.push_back(static_cast<char>(c));
+      if (last.size()>n) last.erase(0, 1);
+      if (last==term) return;
+    }
+    casadi_error("Expected " + string(term) + " in XML document");
+  }
+
+  void XmlReader::expect(char c) {
+    int r = buf_->sbumpc();
+    casadi_assert(r==c, "Expected '" + string(1, c) + "' in XML document");
+  }
+
+  void XmlReader::append_text(string& s, int term) {
+    int c;
+    while ((c = buf_->sgetc())!=EOF && c!=term) {
+      buf_->sbumpc();
+      if (c!='&') {
+        s.push_back(static_cast<char>(c));
+        continue;
+      }
+      // Entity reference
+      string ent;
+      while ((c = buf_->sbumpc())!=EOF && c!=';') ent.push_back(static_cast<char>(c));
+      if (ent=="lt") {
+        s.push_back('<');
+      } else if (ent=="gt") {
+        s.push_back('>');
+      } else if (ent=="amp") {
+        s.push_back('&');
+      } else if (ent=="quot") {
+        s.push_back('"');
+      } else if (ent=="apos") {
+        s.push_back('\'');
+      } else if (ent.size()>1 && ent[0]=='#') {
+        // Character reference, encoded as UTF-8
+        unsigned long cp = ent[1]=='x' ? strtoul(ent.c_str()+2, nullptr, 16)
+                                       : strtoul(ent.c_str()+1, nullptr, 10);
+        if (cp<0x80) {
+          s.push_back(static_cast<char>(cp));
+        } else if (cp<0x800) {
+          s.push_back(static_cast<char>(0xC0 | (cp >> 6)));
+          s.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+        } else if (cp<0x10000) {
+          s.push_back(static_cast<char>(0xE0 | (cp >> 12)));
+          s.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+          s.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+        } else {
+          s.push_back(static_cast<char>(0xF0 | (cp >> 18)));
+          s.push_back(static_cast<char>(0x80 | ((cp >> 12) & 0x3F)));
+          s.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+          s.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+        }
+      } else {
+        casadi_error("Unknown entity &" + ent + "; in XML document");
+      }
+    }
+  }
+
+} // namespace casadi
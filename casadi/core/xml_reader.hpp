@@ -0,0 +1,115 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+#ifndef CASADI_XML_READER_HPP
+#define CASADI_XML_READER_HPP
+
+#include <fstream>
+#include <string>
+#include <vector>
+#include "xml_node.hpp"
+
+/// \cond INTERNAL
+
+namespace casadi {
+
+  /** \brief Streaming XML reader
+
+      Reports the start and end tags of a document in order without building
+      the document tree. Subtrees of interest can be read into an XmlNode one
+      at a time, so that memory use is bounded by the largest such subtree
+      rather than by the size of the document.
+  */
+  class CASADI_EXPORT XmlReader {
+  public:
+    /** \brief  Open a file for reading */
+    explicit XmlReader(const std::string& filename);
+
+    /** \brief  Advance to the next start or end tag, false at the end of the document
+        A self-closing element is reported as a start tag followed by an end tag.
+    */
+    bool next();
+
+    /** \brief  Is the current tag a start tag? */
+    bool is_start() const { return is_start_;}
+
+    /** \brief  Depth of the current element, zero for the root element */
+    casadi_int depth() const { return depth_;}
+
+    /** \brief  Name and attributes of the element at the last start tag */
+    const XmlNode& node() const { return node_;}
+
+    /** \brief  Read the element at the current start tag, including its children
+        On return, the current tag is the end tag of the element.
+    */
+    XmlNode read_node();
+
+  private:
+    /// Token types
+    enum Token {TOKEN_START, TOKEN_END, TOKEN_TEXT, TOKEN_EOF};
+
+    /// Read the next tag or piece of text
+    Token read_token();
+
+    /// Read a name of an element or attribute
+    void read_name(std::string& s);
+
+    /// Skip white space
+    void skip_space();
+
+    /// Skip past a terminating string
+    void skip_past(const char* term);
+
+    /// Read and check the next character
+    void expect(char c);
+
+    /// Append a piece of text, replacing entity references
+    void append_text(std::string& s, int term);
+
+    /// Open an element at a start tag
+    void open();
+
+    /// Close an element at an end tag
+    void close(const std::string& name);
+
+    // Input file and its buffer
+    std::ifstream file_;
+    std::streambuf* buf_;
+
+    // Names of the elements currently open
+    std::vector<std::string> open_;
+
+    // Current tag
+    XmlNode node_;
+    std::string name_, text_, att_name_, att_val_;
+    bool is_start_, self_closing_, pending_end_;
+    casadi_int depth_;
+  };
+
+} // namespace casadi
+/// \endcond
+
+#endif // CASADI_XML_READER_HPP
@@ -397,6 +397,7 @@ namespace casadi {
       m->alpha_du.push_back(alpha_du);
       m->ls_trials.push_back(ls_trials);
       m->obj.push_back(obj_value);
+      if (m->stop && *m->stop) return 0;
       if (!fcallback_.is_null()) {
         m->fstats.at("callback_fun").tic();
         if (full_callback) {
@@ -208,7 +208,8 @@ namespace casadi {
     for (casadi_int i=0;i<n_out_;++i) {
       g << "res[" + str(i+n_out_+1) + "] = " << (i==iout_? "m.g" : "res[" + str(i)+ "]") << ";\n";
     }
-    g << jac_f_z + "(arg+" + str(n_in_) + ", res+" + str(n_out_) + ", iw, w, 0);\n";
+    g << jac_f_z + "(arg+" + str(n_in_) + ", res+" + str(n_out_) + ", iw, w+"
+      << w_offset << ", 0);\n";
     g << "if (casadi_newton(&m)) break;\n";
     g << "}\n";
 
@@ -0,0 +1,240 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+#include "ipqp.hpp"
+
+using namespace std;
+namespace casadi {
+
+  extern "C"
+  int CASADI_CONIC_IPQP_EXPORT
+  casadi_register_conic_ipqp(Conic::Plugin* plugin) {
+    plugin->creator = Ipqp::creator;
+    plugin->name = "ipqp";
+    plugin->doc = Ipqp::meta_doc.c_str();
+    plugin->version = CASADI_VERSION;
+    plugin->options = &Ipqp::options_;
+    return 0;
+  }
+
+  extern "C"
+  void CASADI_CONIC_IPQP_EXPORT casadi_load_conic_ipqp() {
+    Conic::registerPlugin(casadi_register_conic_ipqp);
+  }
+
+  Ipqp::Ipqp(const std::string& name, const std::map<std::string, Sparsity> &st)
+    : Conic(name, st) {
+  }
+
+  Ipqp::~Ipqp() {
+    clear_mem();
+  }
+
+  Options Ipqp::options_
+  = {{&Conic::options_},
+     {{"max_iter",
+       {OT_INT,
+        "Maximum number of iterations [100]."}},
+      {"max_refine",
+       {OT_INT,
+        "Maximum number of iterative refinement steps per linear solve [5]."}},
+      {"tol",
+       {OT_DOUBLE,
+        "Tolerance on primal and dual infeasibility and complementarity [1e-8]."}},
+      {"reg",
+       {OT_DOUBLE,
+        "Regularization of the factorized KKT system, removed by iterative refinement [1e-9]."}},
+      {"print_header",
+       {OT_BOOL,
+        "Print header [true]."}},
+      {"print_iter",
+       {OT_BOOL,
+        "Print iterations [true]."}}
+     }
+  };
+
+  void Ipqp::init(const Dict& opts) {
+    // Initialize the base classes
+    Conic::init(opts);
+
+    // Default options
+    max_iter_ = 100;
+    max_refine_ = 5;
+    tol_ = 1e-8;
+    reg_ = 1e-9;
+    print_iter_ = true;
+    print_header_ = true;
+
+    // Read user options
+    for (auto&& op : opts) {
+      if (op.first=="max_iter") {
+        max_iter_ = op.second;
+      } else if (op.first=="max_refine") {
+        max_refine_ = op.second;
+      } else if (op.first=="tol") {
+        tol_ = op.second;
+      } else if (op.first=="reg") {
+        reg_ = op.second;
+      } else if (op.first=="print_iter") {
+        print_iter_ = op.second;
+      } else if (op.first=="print_header") {
+        print_header_ = op.second;
+      }
+    }
+
+    // Transpose of the Jacobian
+    AT_ = A_.T();
+
+    // Assemble KKT system sparsity
+    kkt_ = Sparsity::kkt(H_, A_, true, true);
+
+    // Symbolic LDL factorization
+    sp_lt_ = kkt_.ldl(perm_);
+
+    // Setup memory structure
+    p_.sp_a = A_;
+    p_.sp_h = H_;
+    p_.inf = inf;
+    p_.tau = 0.995;
+    p_.reg = 1e-8;
+    p_.nx = nx_;
+    p_.na = na_;
+    p_.nz = nx_+na_;
+    p_.max_iter = max_iter_;
+    p_.max_refine = max_refine_;
+    p_.tol = tol_;
+
+    // Allocate memory
+    casadi_int sz_w, sz_iw;
+    casadi_ipqp_work(&p_, &sz_iw, &sz_w);
+    alloc_iw(sz_iw, true);
+    alloc_w(sz_w, true);
+    alloc_iw(na_, true); // casadi_trans
+    alloc_w(AT_.nnz(), true); // nz_at
+    alloc_w(kkt_.nnz(), true); // nz_kkt
+    alloc_w(sp_lt_.nnz(), true); // nz_lt
+    alloc_w(nx_+na_, true); // D of the factorization
+    alloc_w(nx_+na_, true); // ldl work
+
+    if (print_header_) {
+      // Print summary
+      print("-------------------------------------------\n");
+      print("This is casadi::IPQP\n");
+      print("Number of variables:                       %9d\n", nx_);
+      print("Number of constraints:                     %9d\n", na_);
+      print("Number of nonzeros in H:                   %9d\n", H_.nnz());
+      print("Number of nonzeros in A:                   %9d\n", A_.nnz());
+      print("Number of nonzeros in KKT:                 %9d\n", kkt_.nnz());
+      print("Number of nonzeros in LDL(L):              %9d\n", sp_lt_.nnz());
+    }
+  }
+
+  int Ipqp::init_mem(void* mem) const {
+    auto m = static_cast<IpqpMemory*>(mem);
+    m->return_status = "";
+    m->success = false;
+    m->iter_count = 0;
+    return 0;
+  }
+
+  int Ipqp::
+  eval(const double** arg, double** res, casadi_int* iw, double* w, void* mem) const {
+    auto m = static_cast<IpqpMemory*>(mem);
+    // Reset statistics
+    for (auto&& s : m->fstats) s.second.reset();
+    // Check inputs
+    if (inputs_check_) {
+      check_inputs(arg[CONIC_LBX], arg[CONIC_UBX], arg[CONIC_LBA], arg[CONIC_UBA]);
+    }
+    // Setup data structure
+    casadi_ipqp_data<double> d;
+    d.prob = &p_;
+    d.nz_h = arg[CONIC_H];
+    d.g = arg[CONIC_G];
+    d.nz_a = arg[CONIC_A];
+    casadi_ipqp_init(&d, iw, w);
+    casadi_int sz_iw, sz_w;
+    casadi_ipqp_work(&p_, &sz_iw, &sz_w);
+    iw += sz_iw;
+    w += sz_w;
+    // KKT system and its factorization
+    casadi_int* iw_at = iw; iw += na_;
+    double* nz_at = w; w += AT_.nnz();
+    double* nz_kkt = w; w += kkt_.nnz();
+    double* nz_lt = w; w += sp_lt_.nnz();
+    double* d_ldl = w; w += p_.nz;
+    double* w_ldl = w; w += p_.nz;
+    // Pass bounds
+    casadi_ipqp_bounds(&d, arg[CONIC_LBX], arg[CONIC_UBX], arg[CONIC_LBA], arg[CONIC_UBA]);
+    // Pass initial guess
+    casadi_copy(arg[CONIC_X0], nx_, d.z);
+    // Transpose of A
+    casadi_trans(d.nz_a, A_, nz_at, AT_, iw_at);
+    // Reset solver
+    if (casadi_ipqp_reset(&d)) {
+      m->return_status = "Inconsistent bounds";
+      m->success = false;
+      return 1;
+    }
+    // Interior point iterations
+    while (true) {
+      int task = casadi_ipqp(&d);
+      if (task==IPQP_DONE) {
+        break;
+      } else if (task==IPQP_PROGRESS) {
+        if (print_iter_) print("%s", d.msg);
+      } else if (task==IPQP_FACTOR) {
+        // Increase the regularization until the pivots have the signs of a
+        // quasi-definite system: positive for variables, negative for constraints
+        for (double reg = reg_; ; reg *= 100) {
+          casadi_ipqp_kkt(&d, kkt_, nz_kkt, AT_, nz_at, reg, w_ldl);
+          casadi_ldl(kkt_, nz_kkt, sp_lt_, nz_lt, d_ldl, get_ptr(perm_), w_ldl);
+          if (reg>=1e-2 || casadi_ipqp_inertia(&d, d_ldl, get_ptr(perm_), reg)) break;
+        }
+      } else if (task==IPQP_SOLVE) {
+        casadi_ldl_solve(d.v, 1, sp_lt_, nz_lt, d_ldl, get_ptr(perm_), w_ldl);
+      }
+    }
+    if (print_iter_) print("%s", d.msg);
+    m->return_status = d.status ? "Maximum number of iterations reached" : "success";
+    // Get solution
+    casadi_ipqp_solution(&d, res[CONIC_COST], res[CONIC_X], res[CONIC_LAM_X], res[CONIC_LAM_A]);
+    // Return
+    if (verbose_) casadi_warning(m->return_status);
+    m->iter_count = d.iter;
+    m->success = d.status==0;
+    return 0;
+  }
+
+  Dict Ipqp::get_stats(void* mem) const {
+    Dict stats = Conic::get_stats(mem);
+    auto m = static_cast<IpqpMemory*>(mem);
+    stats["return_status"] = m->return_status;
+    stats["success"] = m->success;
+    stats["iter_count"] = m->iter_count;
+    return stats;
+  }
+
+} // namespace casadi
@@ -111,28 +111,22 @@ namespace casadi {
     return ret;
   }
 
+  size_t LinsolLdl::codegen_sz_w() const {
+    return sp_Lt_.nnz() + 2*nrow();
+  }
+
   void LinsolLdl::generate(CodeGenerator& g, const std::string& A, const std::string& x,
-                          casadi_int nrhs, bool tr) const {
-    // Codegen the integer vectors
-    string sp = g.sparsity(sp_);
-    string sp_Lt = g.sparsity(sp_Lt_);
-    string p = g.constant(p_);
-
-    // Place in block to avoid conflicts caused by local variables
-    g << "{\n";
-    g.comment("FIXME(@jaeandersson): Memory allocation can be avoided");
-    g << "casadi_real lt[" << sp_Lt_.nnz() << "], "
-         "d[" << nrow() << "], "
-         "w[" << nrow() << "];\n";
+                          casadi_int nrhs, bool tr, const std::string& w) const {
+    // Partition the work vector supplied by the caller
+    string lt = w;
+    string d = w + "+" + str(sp_Lt_.nnz());
+    string w1 = w + "+" + str(sp_Lt_.nnz() + nrow());
 
     // Factorize
-    g << g.ldl(sp, A, sp_Lt, "lt", "d", p, "w") << "\n";
+    g << g.ldl(sp_, A, sp_Lt_, lt, d, p_, w1) << "\n";
 
     // Solve
-    g << g.ldl_solve(x, nrhs, sp_Lt, "lt", "d", p, "w") << "\n";
-
-    // End of block
-    g << "}\n";
+    g << g.ldl_solve(x, nrhs, sp_Lt_, lt, d, p_, w1) << "\n";
   }
 
 } // namespace casadi
@@ -82,7 +82,10 @@ namespace casadi {
 
     /// Generate C code
     void generate(CodeGenerator& g, const std::string& A, const std::string& x,
-                  casadi_int nrhs, bool tr) const override;
+                  casadi_int nrhs, bool tr, const std::string& w) const override;
+
+    /// Size of the work vector needed by the generated code
+    size_t codegen_sz_w() const override;
 
     /// Number of negative eigenvalues
     casadi_int neig(void* mem, const double* A) const override;
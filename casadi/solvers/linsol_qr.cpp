@@ -93,8 +93,12 @@ namespace casadi {
     return 0;
   }
 
+  size_t LinsolQr::codegen_sz_w() const {
+    return sp_v_.nnz() + sp_r_.nnz() + 2*ncol() + nrow();
+  }
+
   void LinsolQr::generate(CodeGenerator& g, const std::string& A, const std::string& x,
-                          casadi_int nrhs, bool tr) const {
+                          casadi_int nrhs, bool tr, const std::string& w) const {
     // Codegen the integer vectors
     string prinv = g.constant(prinv_);
     string pc = g.constant(pc_);
@@ -102,22 +106,21 @@ namespace casadi {
     string sp_v = g.sparsity(sp_v_);
     string sp_r = g.sparsity(sp_r_);
 
-    // Place in block to avoid conflicts caused by local variables
-    g << "{\n";
-    g.comment("FIXME(@jaeandersson): Memory allocation can be avoided");
-    g << "casadi_real v[" << sp_v_.nnz() << "], "
-         "r[" << sp_r_.nnz() << "], "
-         "beta[" << ncol() << "], "
-         "w[" << nrow() + ncol() << "];\n";
+    // Partition the work vector supplied by the caller
+    casadi_int offset = 0;
+    string v = w;
+    offset += sp_v_.nnz();
+    string r = w + "+" + str(offset);
+    offset += sp_r_.nnz();
+    string beta = w + "+" + str(offset);
+    offset += ncol();
+    string w1 = w + "+" + str(offset);
 
     // Factorize
-    g << g.qr(sp, A, "w", sp_v, "v", sp_r, "r", "beta", prinv, pc) << "\n";
+    g << g.qr(sp, A, w1, sp_v, v, sp_r, r, beta, prinv, pc) << "\n";
 
     // Solve
-    g << g.qr_solve(x, nrhs, tr, sp_v, "v", sp_r, "r", "beta", prinv, pc, "w") << "\n";
-
-    // End of block
-    g << "}\n";
+    g << g.qr_solve(x, nrhs, tr, sp_v, v, sp_r, r, beta, prinv, pc, w1) << "\n";
   }
 
 } // namespace casadi
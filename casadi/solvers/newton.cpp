@@ -66,7 +66,21 @@ namespace casadi {
         "Maximum number of Newton iterations to perform before returning."}},
       {"print_iteration",
        {OT_BOOL,
-        "Print information about each iteration"}}
+        "Print information about each iteration"}},
+      {"reuse_jacobian",
+       {OT_INT,
+        "Maximum number of iterations a factorization of the Jacobian is used for "
+        "before it is recalculated (chord method). Default: 1, i.e. full Newton."}},
+      {"max_contraction",
+       {OT_DOUBLE,
+        "Recalculate the Jacobian before its reuse limit if the residual decreased "
+        "by less than this factor in the last iteration. Default: 0.5"}},
+      {"line_search",
+       {OT_BOOL,
+        "Damp the steps with an Armijo backtracking line search on the residual norm"}},
+      {"max_iter_ls",
+       {OT_INT,
+        "Maximum number of step reductions in the line search. Default: 10"}}
      }
   };
 
@@ -80,6 +94,10 @@ namespace casadi {
     abstol_ = 1e-12;
     abstolStep_ = 1e-12;
     print_iteration_ = false;
+    reuse_jacobian_ = 1;
+    max_contraction_ = 0.5;
+    line_search_ = false;
+    max_iter_ls_ = 10;
 
     // Read options
     for (auto&& op : opts) {
@@ -91,18 +109,33 @@ namespace casadi {
         abstolStep_ = op.second;
       } else if (op.first=="print_iteration") {
         print_iteration_ = op.second;
+      } else if (op.first=="reuse_jacobian") {
+        reuse_jacobian_ = op.second;
+      } else if (op.first=="max_contraction") {
+        max_contraction_ = op.second;
+      } else if (op.first=="line_search") {
+        line_search_ = op.second;
+      } else if (op.first=="max_iter_ls") {
+        max_iter_ls_ = op.second;
       }
     }
+    casadi_assert(reuse_jacobian_>=1, "Newton: reuse_jacobian must be at least 1");
 
     casadi_assert(oracle_.n_in()>0,
                           "Newton: the supplied f must have at least one input.");
     casadi_assert(!linsol_.is_null(),
                           "Newton::init: linear_solver must be supplied");
 
+    // Residual without the Jacobian, when the factorization is reused
+    set_function(oracle_, "g");
+
     // Allocate memory
     alloc_w(n_, true); // x
     alloc_w(n_, true); // F
     alloc_w(sp_jac_.nnz(), true); // J
+    alloc_w(n_, true); // dx
+    alloc_w(n_, true); // x_trial
+    alloc_w(n_, true); // f_trial
   }
 
  void Newton::set_work(void* mem, const double**& arg, double**& res,
@@ -112,6 +145,9 @@ namespace casadi {
      m->x = w; w += n_;
      m->f = w; w += n_;
      m->jac = w; w += sp_jac_.nnz();
+     m->dx = w; w += n_;
+     m->x_trial = w; w += n_;
+     m->f_trial = w; w += n_;
   }
 
   int Newton::solve(void* mem) const {
@@ -124,7 +160,16 @@ namespace casadi {
 
     // Perform the Newton iterations
     m->iter=0;
+    m->n_fact=0;
+    m->n_backtrack=0;
     bool success = true;
+
+    // Iterations since the last factorization
+    casadi_int age = 0;
+    // Is m->f the residual at m->x?
+    bool have_f = false;
+    // Residual norm at the previous iterate
+    double abstol_prev = numeric_limits<double>::infinity();
     while (true) {
       // Break if maximum number of iterations already reached
       if (m->iter >= max_iter_) {
@@ -137,36 +182,55 @@ namespace casadi {
       // Start a new iteration
       m->iter++;
 
+      // Reuse the factorization unless it is too old
+      bool refresh = m->n_fact==0 || age>=reuse_jacobian_;
+
+      // Evaluate the residual only
+      if (!refresh && !have_f) {
+        copy_n(m->iarg, n_in_, m->arg);
+        m->arg[iin_] = m->x;
+        copy_n(m->ires, n_out_, m->res);
+        m->res[iout_] = m->f;
+        calc_function(m, "g");
+        have_f = true;
+      }
+
+      // Refresh the factorization if the convergence has slowed down
+      if (!refresh && casadi_norm_inf(n_, m->f) > max_contraction_*abstol_prev) {
+        refresh = true;
+      }
+
       // Use x to evaluate J
-      copy_n(m->iarg, n_in_, m->arg);
-      m->arg[iin_] = m->x;
-      m->res[0] = m->jac;
-      copy_n(m->ires, n_out_, m->res+1);
-      m->res[1+iout_] = m->f;
-      calc_function(m, "jac_f_z");
+      if (refresh) {
+        copy_n(m->iarg, n_in_, m->arg);
+        m->arg[iin_] = m->x;
+        m->res[0] = m->jac;
+        copy_n(m->ires, n_out_, m->res+1);
+        m->res[1+iout_] = m->f;
+        calc_function(m, "jac_f_z");
+      }
 
       // Check convergence
-      double abstol = 0;
-      if (abstol_ != numeric_limits<double>::infinity()) {
-        for (casadi_int i=0; i<n_; ++i) {
-          abstol = max(abstol, fabs(m->f[i]));
-        }
-        if (abstol <= abstol_) {
-          if (verbose_) casadi_message("Converged to acceptable tolerance: " + str(abstol_));
-          break;
-        }
+      double abstol = casadi_norm_inf(n_, m->f);
+      if (abstol_ != numeric_limits<double>::infinity() && abstol <= abstol_) {
+        if (verbose_) casadi_message("Converged to acceptable tolerance: " + str(abstol_));
+        break;
       }
 
       // Factorize the linear solver with J
-      linsol_.nfact(m->jac, mem_linsol);
-      linsol_.solve(m->jac, m->f, 1, false, mem_linsol);
+      if (refresh) {
+        linsol_.nfact(m->jac, mem_linsol);
+        m->n_fact++;
+        age = 0;
+      }
+      age++;
+      casadi_copy(m->f, n_, m->dx);
+      linsol_.solve(m->jac, m->dx, 1, false, mem_linsol);
 
       // Check convergence again
       double abstolStep=0;
       if (numeric_limits<double>::infinity() != abstolStep_) {
-        for (casadi_int i=0; i<n_; ++i) {
-          abstolStep = max(abstolStep, fabs(m->f[i]));
-        }
+        abstolStep = casadi_norm_inf(n_, m->dx);
         if (abstolStep <= abstolStep_) {
           if (verbose_) casadi_message("Converged to acceptable tolerance: " + str(abstolStep_));
           break;
@@ -183,8 +247,54 @@ namespace casadi {
         printIteration(uout(), m->iter, abstol, abstolStep);
       }
 
-      // Update Xk+1 = Xk - J^(-1) F
-      casadi_axpy(n_, -1., m->f, m->x);
+      if (!line_search_) {
+        // Update Xk+1 = Xk - J^(-1) F
+        casadi_axpy(n_, -1., m->dx, m->x);
+        have_f = false;
+        abstol_prev = abstol;
+        continue;
+      }
+
+      // Backtracking line search on |F|^2, which decreases along exact Newton steps
+      const double c1 = 1e-4;
+      double f2 = casadi_dot(n_, m->f, m->f);
+      double alpha = 1;
+      bool accepted = false;
+      for (casadi_int ls_iter=0; ; ++ls_iter) {
+        // Residual at the trial point
+        casadi_copy(m->x, n_, m->x_trial);
+        casadi_axpy(n_, -alpha, m->dx, m->x_trial);
+        copy_n(m->iarg, n_in_, m->arg);
+        m->arg[iin_] = m->x_trial;
+        copy_n(m->ires, n_out_, m->res);
+        m->res[iout_] = m->f_trial;
+        calc_function(m, "g");
+
+        // Armijo condition
+        if (casadi_dot(n_, m->f_trial, m->f_trial) <= (1 - 2*c1*alpha)*f2) {
+          accepted = true;
+          break;
+        }
+        if (ls_iter>=max_iter_ls_) break;
+        alpha *= 0.5;
+        m->n_backtrack++;
+      }
+
+      if (accepted) {
+        casadi_copy(m->x_trial, n_, m->x);
+        casadi_copy(m->f_trial, n_, m->f);
+        have_f = true;
+        abstol_prev = abstol;
+      } else if (age>1) {
+        // Stale Jacobian, retry from the same point with a fresh one
+        have_f = false;
+        age = reuse_jacobian_;
+      } else {
+        if (verbose_) casadi_message("Line search failed.");
+        m->return_status = "line_search_failed";
+        success = false;
+        break;
+      }
     }
 
     // Get the solution
@@ -223,6 +333,8 @@ namespace casadi {
     auto m = static_cast<NewtonMemory*>(mem);
     m->return_status = nullptr;
     m->iter = 0;
+    m->n_fact = 0;
+    m->n_backtrack = 0;
     return 0;
   }
 
@@ -231,6 +343,8 @@ namespace casadi {
     auto m = static_cast<NewtonMemory*>(mem);
     stats["return_status"] = m->return_status;
     stats["iter_count"] = m->iter;
+    stats["n_fact"] = m->n_fact;
+    stats["n_backtrack"] = m->n_backtrack;
     return stats;
   }
 
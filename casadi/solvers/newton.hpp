@@ -47,10 +47,19 @@ namespace casadi {
     double* f;
     // Current Jacobian
     double* jac;
+    // Newton step
+    double* dx;
+    // Trial point and its residual in the line search
+    double* x_trial;
+    double* f_trial;
     // Return status
     const char* return_status;
     // Number of iterations
     casadi_int iter;
+    // Number of Jacobian factorizations
+    casadi_int n_fact;
+    // Number of step reductions in the line search
+    casadi_int n_backtrack;
   };
 
   /** \brief \pluginbrief{Rootfinder,newton}
@@ -124,6 +133,18 @@ namespace casadi {
     /// If true, each iteration will be printed
     bool print_iteration_;
 
+    /// Maximum number of iterations a Jacobian factorization is used for
+    casadi_int reuse_jacobian_;
+
+    /// Refresh the Jacobian if the residual decreases by less than this factor
+    double max_contraction_;
+
+    /// Armijo backtracking line search
+    bool line_search_;
+
+    /// Maximum number of step reductions in the line search
+    casadi_int max_iter_ls_;
+
     bool error_on_;
 
     /// Print iteration header
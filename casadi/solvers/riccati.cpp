@@ -0,0 +1,292 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+#include "riccati.hpp"
+
+using namespace std;
+namespace casadi {
+
+  extern "C"
+  int CASADI_CONIC_RICCATI_EXPORT
+  casadi_register_conic_riccati(Conic::Plugin* plugin) {
+    plugin->creator = Riccati::creator;
+    plugin->name = "riccati";
+    plugin->doc = Riccati::meta_doc.c_str();
+    plugin->version = CASADI_VERSION;
+    plugin->options = &Riccati::options_;
+    return 0;
+  }
+
+  extern "C"
+  void CASADI_CONIC_RICCATI_EXPORT casadi_load_conic_riccati() {
+    Conic::registerPlugin(casadi_register_conic_riccati);
+  }
+
+  Riccati::Riccati(const std::string& name, const std::map<std::string, Sparsity> &st)
+    : Conic(name, st) {
+  }
+
+  Riccati::~Riccati() {
+    clear_mem();
+  }
+
+  Options Riccati::options_
+  = {{&Conic::options_},
+     {{"max_iter",
+       {OT_INT,
+        "Maximum number of iterations [100]."}},
+      {"max_refine",
+       {OT_INT,
+        "Maximum number of iterative refinement steps per linear solve [2]."}},
+      {"tol",
+       {OT_DOUBLE,
+        "Tolerance on primal and dual infeasibility and complementarity [1e-8]."}},
+      {"print_header",
+       {OT_BOOL,
+        "Print header [true]."}},
+      {"print_iter",
+       {OT_BOOL,
+        "Print iterations [true]."}}
+     }
+  };
+
+  void Riccati::init(const Dict& opts) {
+    // Initialize the base classes
+    Conic::init(opts);
+
+    // Default options
+    max_iter_ = 100;
+    max_refine_ = 2;
+    tol_ = 1e-8;
+    print_iter_ = true;
+    print_header_ = true;
+
+    // Read user options
+    for (auto&& op : opts) {
+      if (op.first=="max_iter") {
+        max_iter_ = op.second;
+      } else if (op.first=="max_refine") {
+        max_refine_ = op.second;
+      } else if (op.first=="tol") {
+        tol_ = op.second;
+      } else if (op.first=="print_iter") {
+        print_iter_ = op.second;
+      } else if (op.first=="print_header") {
+        print_header_ = op.second;
+      }
+    }
+
+    // Sparsity patterns
+    const casadi_int *h_colind = H_.colind(), *h_row = H_.row();
+    const casadi_int *a_colind = A_.colind(), *a_row = A_.row();
+
+    // Detect the stages
+    vector<casadi_int> xperm, xoff, gperm, goff;
+    casadi_int nb = Sparsity::stages(H_, A_, xperm, xoff, gperm, goff);
+
+    // Stacked ordering: the variables of each stage followed by its rows
+    perm_.clear();
+    off_ = {0};
+    for (casadi_int b=0; b<nb; ++b) {
+      for (casadi_int k=xoff[b]; k<xoff[b+1]; ++k) perm_.push_back(xperm[k]);
+      for (casadi_int k=goff[b]; k<goff[b+1]; ++k) perm_.push_back(nx_+gperm[k]);
+      off_.push_back(perm_.size());
+    }
+    vector<casadi_int> iperm(perm_.size()), stage(perm_.size());
+    for (casadi_int b=0; b<nb; ++b) {
+      for (casadi_int s=off_[b]; s<off_[b+1]; ++s) {
+        iperm[perm_[s]] = s;
+        stage[perm_[s]] = b;
+      }
+    }
+
+    // Storage for the diagonal blocks followed by the subdiagonal blocks
+    off_d_.resize(nb);
+    off_c_.resize(nb);
+    casadi_int nnz_kkt = 0, nmax = 0;
+    for (casadi_int b=0; b<nb; ++b) {
+      casadi_int n = off_[b+1]-off_[b];
+      nmax = max(nmax, n);
+      off_d_[b] = nnz_kkt;
+      nnz_kkt += n*n;
+    }
+    for (casadi_int b=0; b<nb; ++b) {
+      off_c_[b] = nnz_kkt;
+      if (b+1<nb) nnz_kkt += (off_[b+2]-off_[b+1])*(off_[b+1]-off_[b]);
+    }
+
+    // Position of entry (i, j) of the KKT system in the block storage
+    auto kkt_pos = [&](casadi_int i, casadi_int j) -> casadi_int {
+      casadi_int bi = stage[i], bj = stage[j];
+      casadi_int li = iperm[i]-off_[bi], lj = iperm[j]-off_[bj];
+      if (bi==bj) return off_d_[bi] + li + lj*(off_[bi+1]-off_[bi]);
+      if (bi==bj+1) return off_c_[bj] + li + lj*(off_[bi+1]-off_[bi]);
+      casadi_assert(bi+1==bj, "Notify the CasADi developers.");
+      return -1;
+    };
+    h_map_.resize(H_.nnz());
+    for (casadi_int c=0; c<nx_; ++c) {
+      for (casadi_int k=h_colind[c]; k<h_colind[c+1]; ++k) {
+        h_map_[k] = kkt_pos(h_row[k], c);
+      }
+    }
+    a_map_.resize(A_.nnz());
+    at_map_.resize(A_.nnz());
+    for (casadi_int c=0; c<nx_; ++c) {
+      for (casadi_int k=a_colind[c]; k<a_colind[c+1]; ++k) {
+        a_map_[k] = kkt_pos(nx_+a_row[k], c);
+        at_map_[k] = kkt_pos(c, nx_+a_row[k]);
+      }
+    }
+
+    // Setup memory structures
+    p_.sp_a = A_;
+    p_.sp_h = H_;
+    p_.inf = inf;
+    p_.tau = 0.995;
+    p_.reg = 1e-8;
+    p_.nx = nx_;
+    p_.na = na_;
+    p_.nz = nx_+na_;
+    p_.max_iter = max_iter_;
+    p_.max_refine = max_refine_;
+    p_.tol = tol_;
+    rp_.nx = nx_;
+    rp_.na = na_;
+    rp_.nz = nx_+na_;
+    rp_.sp_a = A_;
+    rp_.sp_h = H_;
+    rp_.nb = nb;
+    rp_.nmax = nmax;
+    rp_.off = get_ptr(off_);
+    rp_.perm = get_ptr(perm_);
+    rp_.off_d = get_ptr(off_d_);
+    rp_.off_c = get_ptr(off_c_);
+    rp_.h_map = get_ptr(h_map_);
+    rp_.a_map = get_ptr(a_map_);
+    rp_.at_map = get_ptr(at_map_);
+    rp_.reg = 1e-10;
+
+    // Allocate memory
+    casadi_int sz_w, sz_iw;
+    casadi_ipqp_work(&p_, &sz_iw, &sz_w);
+    alloc_iw(sz_iw, true);
+    alloc_w(sz_w, true);
+    casadi_riccati_work(&rp_, &sz_iw, &sz_w);
+    alloc_iw(sz_iw, true);
+    alloc_w(sz_w, true);
+
+    if (print_header_) {
+      // Print summary
+      print("-------------------------------------------\n");
+      print("This is casadi::Riccati\n");
+      print("Number of variables:                       %9d\n", nx_);
+      print("Number of constraints:                     %9d\n", na_);
+      print("Number of nonzeros in H:                   %9d\n", H_.nnz());
+      print("Number of nonzeros in A:                   %9d\n", A_.nnz());
+      print("Number of stages:                          %9d\n", nb);
+      print("Largest stage:                             %9d\n", nmax);
+    }
+  }
+
+  int Riccati::init_mem(void* mem) const {
+    auto m = static_cast<RiccatiMemory*>(mem);
+    m->return_status = "";
+    m->success = false;
+    m->iter_count = 0;
+    return 0;
+  }
+
+  int Riccati::
+  eval(const double** arg, double** res, casadi_int* iw, double* w, void* mem) const {
+    auto m = static_cast<RiccatiMemory*>(mem);
+    // Reset statistics
+    for (auto&& s : m->fstats) s.second.reset();
+    // Check inputs
+    if (inputs_check_) {
+      check_inputs(arg[CONIC_LBX], arg[CONIC_UBX], arg[CONIC_LBA], arg[CONIC_UBA]);
+    }
+    // Setup data structure
+    casadi_ipqp_data<double> d;
+    d.prob = &p_;
+    d.nz_h = arg[CONIC_H];
+    d.g = arg[CONIC_G];
+    d.nz_a = arg[CONIC_A];
+    casadi_ipqp_init(&d, iw, w);
+    casadi_int sz_iw, sz_w;
+    casadi_ipqp_work(&p_, &sz_iw, &sz_w);
+    iw += sz_iw;
+    w += sz_w;
+    // Block factorization
+    casadi_riccati_work(&rp_, &sz_iw, &sz_w);
+    casadi_int* piv = iw;
+    double* kkt = w;
+    w += rp_.off_c[rp_.nb-1];
+    double* w_ric = w;
+    w += sz_w-rp_.off_c[rp_.nb-1];
+    // Pass bounds
+    casadi_ipqp_bounds(&d, arg[CONIC_LBX], arg[CONIC_UBX], arg[CONIC_LBA], arg[CONIC_UBA]);
+    // Pass initial guess
+    casadi_copy(arg[CONIC_X0], nx_, d.z);
+    // Reset solver
+    if (casadi_ipqp_reset(&d)) {
+      m->return_status = "Inconsistent bounds";
+      m->success = false;
+      return 1;
+    }
+    // Interior point iterations
+    while (true) {
+      int task = casadi_ipqp(&d);
+      if (task==IPQP_DONE) {
+        break;
+      } else if (task==IPQP_PROGRESS) {
+        if (print_iter_) print("%s", d.msg);
+      } else if (task==IPQP_FACTOR) {
+        casadi_riccati_factorize(&rp_, d.nz_h, d.nz_a, d.D, kkt, piv, w_ric);
+      } else if (task==IPQP_SOLVE) {
+        casadi_riccati_solve(&rp_, kkt, piv, d.v, w_ric);
+      }
+    }
+    if (print_iter_) print("%s", d.msg);
+    m->return_status = d.status ? "Maximum number of iterations reached" : "success";
+    // Get solution
+    casadi_ipqp_solution(&d, res[CONIC_COST], res[CONIC_X], res[CONIC_LAM_X], res[CONIC_LAM_A]);
+    // Return
+    if (verbose_) casadi_warning(m->return_status);
+    m->iter_count = d.iter;
+    m->success = d.status==0;
+    return 0;
+  }
+
+  Dict Riccati::get_stats(void* mem) const {
+    Dict stats = Conic::get_stats(mem);
+    auto m = static_cast<RiccatiMemory*>(mem);
+    stats["return_status"] = m->return_status;
+    stats["success"] = m->success;
+    stats["iter_count"] = m->iter_count;
+    return stats;
+  }
+
+} // namespace casadi
@@ -0,0 +1,124 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+#ifndef CASADI_RICCATI_HPP
+#define CASADI_RICCATI_HPP
+
+#include "casadi/core/conic_impl.hpp"
+#include <casadi/solvers/casadi_conic_riccati_export.h>
+namespace casadi {
+#include "casadi/core/runtime/casadi_ipqp.hpp"
+#include "casadi/core/runtime/casadi_riccati.hpp"
+} // namespace casadi
+
+/** \defgroup plugin_Conic_riccati
+ Solve QPs with an optimal control structure using a primal-dual interior
+ point method. The KKT system is factorized stage by stage, with the stages
+ detected from the sparsity patterns of H and A by Sparsity::stages, so that
+ the cost of an iteration grows linearly with the horizon length. The
+ variables and constraints may be given in any order.
+*/
+
+/** \pluginsection{Conic,riccati} */
+
+/// \cond INTERNAL
+namespace casadi {
+  struct CASADI_CONIC_RICCATI_EXPORT RiccatiMemory : public ConicMemory {
+    const char* return_status;
+    bool success;
+    casadi_int iter_count;
+  };
+
+  /** \brief \pluginbrief{Conic,riccati}
+
+      @copydoc Conic_doc
+      @copydoc plugin_Conic_riccati
+  */
+  class CASADI_CONIC_RICCATI_EXPORT Riccati : public Conic {
+  public:
+    /** \brief  Create a new Solver */
+    explicit Riccati(const std::string& name,
+                     const std::map<std::string, Sparsity> &st);
+
+    /** \brief  Create a new QP Solver */
+    static Conic* creator(const std::string& name,
+                          const std::map<std::string, Sparsity>& st) {
+      return new Riccati(name, st);
+    }
+
+    /** \brief  Destructor */
+    ~Riccati() override;
+
+    // Get name of the plugin
+    const char* plugin_name() const override { return "riccati";}
+
+    // Get name of the class
+    std::string class_name() const override { return "Riccati";}
+
+    /** \brief Create memory block */
+    void* alloc_mem() const override { return new RiccatiMemory();}
+
+    /** \brief Initalize memory block */
+    int init_mem(void* mem) const override;
+
+    /** \brief Free memory block */
+    void free_mem(void *mem) const override { delete static_cast<RiccatiMemory*>(mem);}
+
+    ///@{
+    /** \brief Options */
+    static Options options_;
+    const Options& get_options() const override { return options_;}
+    ///@}
+
+    /** \brief Initialize */
+    void init(const Dict& opts) override;
+
+    /** \brief Solve the QP */
+    int eval(const double** arg, double** res,
+             casadi_int* iw, double* w, void* mem) const override;
+
+    /// Get all statistics
+    Dict get_stats(void* mem) const override;
+
+    /// A documentation string
+    static const std::string meta_doc;
+    // Memory structures
+    casadi_ipqp_prob<double> p_;
+    casadi_riccati_prob<double> rp_;
+    // Stage structure
+    std::vector<casadi_int> off_, perm_, off_d_, off_c_;
+    // Position of the nonzeros of H, A and A' in the block storage
+    std::vector<casadi_int> h_map_, a_map_, at_map_;
+    ///@{
+    // Options
+    casadi_int max_iter_, max_refine_;
+    double tol_;
+    bool print_iter_, print_header_;
+    ///@}
+  };
+
+} // namespace casadi
+/// \endcond
+#endif // CASADI_RICCATI_HPP
@@ -97,12 +97,23 @@ namespace casadi {
       {"merit_memory",
        {OT_INT,
         "Size of memory to store history of merit function values"}},
+      {"line_search",
+       {OT_STRING,
+        "Globalization strategy: merit|filter [merit]"}},
+      {"max_soc",
+       {OT_INT,
+        "Maximum number of second-order correction steps when the full step is rejected, "
+        "0 disables second-order corrections [0]"}},
       {"lbfgs_memory",
        {OT_INT,
         "Size of L-BFGS memory."}},
       {"regularize",
        {OT_BOOL,
         "Automatic regularization of Lagrange Hessian."}},
+      {"combined_oracle",
+       {OT_BOOL,
+        "Evaluate the objective, the constraints, their derivatives and the exact Hessian "
+        "with a single function, nlp_sqp, that shares intermediate expressions [false]"}},
       {"print_header",
        {OT_BOOL,
         "Print the header with problem statistics"}},
@@ -129,10 +140,13 @@ namespace casadi {
     c1_ = 1e-4;
     beta_ = 0.8;
     merit_memsize_ = 4;
+    string line_search = "merit";
+    max_soc_ = 0;
     lbfgs_memory_ = 10;
     tol_pr_ = 1e-6;
     tol_du_ = 1e-6;
     regularize_ = false;
+    combined_oracle_ = false;
     string hessian_approximation = "exact";
     min_step_size_ = 1e-10;
     string qpsol_plugin = "qpoases";
@@ -155,6 +169,10 @@ namespace casadi {
         beta_ = op.second;
       } else if (op.first=="merit_memory") {
         merit_memsize_ = op.second;
+      } else if (op.first=="line_search") {
+        line_search = op.second.to_string();
+      } else if (op.first=="max_soc") {
+        max_soc_ = op.second;
       } else if (op.first=="lbfgs_memory") {
         lbfgs_memory_ = op.second;
       } else if (op.first=="tol_pr") {
@@ -171,6 +189,8 @@ namespace casadi {
         qpsol_options = op.second;
       } else if (op.first=="regularize") {
         regularize_ = op.second;
+      } else if (op.first=="combined_oracle") {
+        combined_oracle_ = op.second;
       } else if (op.first=="print_header") {
         print_header_ = op.second;
       } else if (op.first=="print_iteration") {
@@ -183,19 +203,73 @@ namespace casadi {
     // Use exact Hessian?
     exact_hessian_ = hessian_approximation =="exact";
 
+    // Filter line search?
+    casadi_assert(line_search=="merit" || line_search=="filter",
+                  "Unknown line search '" + line_search + "', expected 'merit' or 'filter'");
+    filter_ = line_search=="filter";
+
+    // Only the exact Hessian can be evaluated together with the first order derivatives
+    combined_oracle_ = combined_oracle_ && exact_hessian_;
+
     // Get/generate required functions
     create_function("nlp_fg", {"x", "p"}, {"f", "g"});
-    // First order derivative information
-    Function jac_g_fcn = create_function("nlp_jac_fg", {"x", "p"},
-                                        {"f", "grad:f:x", "g", "jac:g:x"});
-    Asp_ = jac_g_fcn.sparsity_out(3);
+    if (combined_oracle_) {
+      // First and second order derivative information in one sweep
+      Function sqp_fcn = create_function("nlp_sqp", {"x", "p", "lam:f", "lam:g"},
+                                         {"f", "grad:f:x", "g", "jac:g:x",
+                                          "sym:hess:gamma:x:x"}, {{"gamma", {"f", "g"}}});
+      Asp_ = sqp_fcn.sparsity_out(3);
+      Hsp_ = sqp_fcn.sparsity_out(4);
+    } else {
+      // First order derivative information
+      Function jac_g_fcn = create_function("nlp_jac_fg", {"x", "p"},
+                                          {"f", "grad:f:x", "g", "jac:g:x"});
+      Asp_ = jac_g_fcn.sparsity_out(3);
+    }
 
-    if (exact_hessian_) {
+    if (combined_oracle_) {
+      // Hessian sparsity already known
+    } else if (exact_hessian_) {
       Function hess_l_fcn = create_function("nlp_hess_l", {"x", "p", "lam:f", "lam:g"},
                                            {"sym:hess:gamma:x:x"}, {{"gamma", {"f", "g"}}});
       Hsp_ = hess_l_fcn.sparsity_out(0);
     } else {
-      Hsp_ = Sparsity::dense(nx_, nx_);
+      // Hessian sparsity by propagating the sparsity of the Lagrangian gradient,
+      // no second order derivatives are generated
+      try {
+        if (has_function("nlp_grad")) {
+          Hsp_ = get_function("nlp_grad").sparsity_jac(0, 2, false, true);
+        } else {
+          Hsp_ = oracle_.factory("nlp_grad_l", {"x", "p", "lam:f", "lam:g"}, {"grad:gamma:x"},
+                                 {{"gamma", {"f", "g"}}}).sparsity_jac(0, 0, false, true);
+        }
+      } catch (exception& e) {
+        // One dense block
+        if (verbose_) casadi_message("Hessian sparsity not available: " + string(e.what()));
+        Hsp_ = Sparsity::dense(nx_, nx_);
+      }
+    }
+
+    // Diagonal blocks of the Hessian, i.e. its connected components
+    vector<casadi_int> p, r;
+    nblk_ = Hsp_.scc(p, r);
+    blk_.resize(nx_);
+    for (casadi_int b=0; b<nblk_; ++b) {
+      for (casadi_int i=r[b]; i<r[b+1]; ++i) blk_[p[i]] = b;
+    }
+
+    // Partitioned BFGS with one dense block per diagonal block of the exact Hessian
+    if (!exact_hessian_) {
+      vector<casadi_int> row, col;
+      for (casadi_int b=0; b<nblk_; ++b) {
+        for (casadi_int i=r[b]; i<r[b+1]; ++i) {
+          for (casadi_int j=r[b]; j<r[b+1]; ++j) {
+            row.push_back(p[j]);
+            col.push_back(p[i]);
+          }
+        }
+      }
+      Hsp_ = Sparsity::triplet(nx_, nx_, row, col);
     }
 
 
@@ -207,7 +281,9 @@ namespace casadi {
 
     // BFGS?
     if (!exact_hessian_) {
-      alloc_w(2*nx_); // casadi_bfgs
+      alloc_w(2*nx_ + 3*nblk_); // casadi_bfgs_block
+    } else if (regularize_) {
+      alloc_w(nblk_); // casadi_regularize_block
     }
 
     // Header
@@ -223,6 +299,7 @@ namespace casadi {
       print("Number of constraints:                     %9d\n", ng_);
       print("Number of nonzeros in constraint Jacobian: %9d\n", Asp_.nnz());
       print("Number of nonzeros in Lagrangian Hessian:  %9d\n", Hsp_.nnz());
+      print("Number of diagonal blocks in Hessian:      %9d\n", nblk_);
       print("\n");
     }
 
@@ -258,6 +335,14 @@ namespace casadi {
 
     // Line-search memory
     alloc_w(merit_memsize_, true);
+
+    // Second-order corrections
+    if (max_soc_>0) {
+      alloc_w(nx_, true); // dx_soc
+      alloc_w(nx_, true); // lam_x_soc
+      alloc_w(ng_, true); // lam_a_soc
+      alloc_w(ng_, true); // g_soc
+    }
   }
 
   void Sqpmethod::set_work(void* mem, const double**& arg, double**& res,
@@ -300,6 +385,14 @@ namespace casadi {
     // merit_mem
     m->merit_mem = w; w += merit_memsize_;
 
+    // Second-order corrections
+    if (max_soc_>0) {
+      m->dx_soc = w; w += nx_;
+      m->lam_x_soc = w; w += nx_;
+      m->lam_a_soc = w; w += ng_;
+      m->g_soc = w; w += ng_;
+    }
+
     m->iter_count = -1;
   }
 
@@ -319,6 +412,11 @@ namespace casadi {
     m->merit_ind = 0;
     m->sigma = 0.;    // NOTE: Move this into the main optimization loop
     m->reg = 0;
+    m->filter.clear();
+    m->n_ls = m->n_qp = m->n_soc = 0;
+
+    // Filter margins, switching condition and second-order correction parameters
+    const double gamma_theta = 1e-5, gamma_f = 1e-5, s_theta = 1.1, s_f = 2.3, kappa_soc = 0.99;
 
     // Default stepsize
     double t = 0;
@@ -335,7 +433,15 @@ namespace casadi {
       m->res[1] = m->gf;
       m->res[2] = m->g;
       m->res[3] = m->Jk;
-      if (calc_function(m, "nlp_jac_fg")) return 1;
+      if (combined_oracle_) {
+        // Also the exact Hessian, with the current multipliers
+        m->arg[2] = &one;
+        m->arg[3] = m->lam_g;
+        m->res[4] = m->Bk;
+        if (calc_function(m, "nlp_sqp")) return 1;
+      } else {
+        if (calc_function(m, "nlp_jac_fg")) return 1;
+      }
 
       // Evaluate the gradient of the Lagrangian
       casadi_copy(m->gf, nx_, m->gLag);
@@ -390,17 +496,18 @@ namespace casadi {
 
       if (exact_hessian_) {
         // Update/reset exact Hessian
-        m->arg[0] = m->x;
-        m->arg[1] = m->p;
-        m->arg[2] = &one;
-        m->arg[3] = m->lam_g;
-        m->res[0] = m->Bk;
-        if (calc_function(m, "nlp_hess_l")) return 1;
+        if (!combined_oracle_) {
+          m->arg[0] = m->x;
+          m->arg[1] = m->p;
+          m->arg[2] = &one;
+          m->arg[3] = m->lam_g;
+          m->res[0] = m->Bk;
+          if (calc_function(m, "nlp_hess_l")) return 1;
+        }
 
-        // Determing regularization parameter with Gershgorin theorem
+        // Regularize each diagonal block using the Gershgorin theorem
         if (regularize_) {
-          m->reg = std::fmin(0, -casadi_lb_eig(Hsp_, m->Bk));
-          if (m->reg > 0) casadi_regularize(Hsp_, m->Bk, m->reg);
+          m->reg = casadi_regularize_block(Hsp_, m->Bk, get_ptr(blk_), nblk_, m->w);
         }
       } else if (m->iter_count==0) {
         // Initialize BFGS
@@ -410,7 +517,7 @@ namespace casadi {
         // Update BFGS
         if (m->iter_count % lbfgs_memory_ == 0) casadi_bfgs_reset(Hsp_, m->Bk);
         // Update the Hessian approximation
-        casadi_bfgs(Hsp_, m->Bk, m->dx, m->gLag, m->gLag_old, m->w);
+        casadi_bfgs_block(Hsp_, m->Bk, get_ptr(blk_), nblk_, m->dx, m->gLag, m->gLag_old, m->w);
       }
 
       // Formulate the QP
@@ -464,11 +571,32 @@ namespace casadi {
         if (meritmax < m->merit_mem[i]) meritmax = m->merit_mem[i];
       }
 
+      // Largest infeasibility accepted by the filter, no Armijo steps above theta_min
+      if (m->iter_count==1) {
+        m->theta_max = 1e4*std::fmax(1., l1_infeas);
+        m->theta_min = 1e-4*std::fmax(1., l1_infeas);
+      }
+
+      // Switching condition: does a step length t promise enough decrease in the objective?
+      auto f_type = [&](double t) {
+        return l1_infeas <= m->theta_min && F_sens < 0
+          && t*pow(-F_sens, s_f) > pow(l1_infeas, s_theta);
+      };
+
+      // Is a candidate for the step length t acceptable?
+      auto acceptable = [&](double t, double f_cand, double theta_cand) {
+        if (!filter_) return f_cand + m->sigma * theta_cand <= meritmax + t * c1_ * L1dir;
+        if (theta_cand > m->theta_max) return false;
+        for (auto&& e : m->filter) {
+          if (theta_cand >= e.first && f_cand >= e.second) return false;
+        }
+        if (f_type(t)) return f_cand <= m->f + t * c1_ * F_sens;
+        return theta_cand <= (1-gamma_theta)*l1_infeas || f_cand <= m->f - gamma_f*l1_infeas;
+      };
+
       // Stepsize
       t = 1.0;
       double fk_cand;
-      // Merit function value in candidate
-      double L1merit_cand = 0;
 
       // Reset line-search counter, success marker
       ls_iter = 0;
@@ -482,6 +610,7 @@ namespace casadi {
         while (true) {
           // Increase counter
           ls_iter++;
+          m->n_ls++;
 
           // Candidate step
           casadi_copy(m->x, nx_, m->x_cand);
@@ -498,12 +627,55 @@ namespace casadi {
             continue;
           }
 
-          // Calculating merit-function in candidate
-          l1_infeas = std::fmax(casadi_max_viol(nx_, m->x_cand, m->lbx, m->ubx),
-                                casadi_max_viol(ng_, m->g_cand, m->lbg, m->ubg));
-          L1merit_cand = fk_cand + m->sigma * l1_infeas;
-          if (L1merit_cand <= meritmax + t * c1_ * L1dir) {
-            break;
+          // Infeasibility in candidate
+          double theta_cand = std::fmax(casadi_max_viol(nx_, m->x_cand, m->lbx, m->ubx),
+                                        casadi_max_viol(ng_, m->g_cand, m->lbg, m->ubg));
+          if (acceptable(t, fk_cand, theta_cand)) break;
+
+          // Full step rejected due to increased infeasibility: try second-order corrections
+          if (ls_iter==1 && max_soc_>0 && ng_>0 && theta_cand >= l1_infeas) {
+            bool soc_accepted = false;
+            casadi_copy(m->dx, nx_, m->dx_soc);
+            casadi_copy(m->qp_DUAL_X, nx_, m->lam_x_soc);
+            casadi_copy(m->qp_DUAL_A, ng_, m->lam_a_soc);
+            for (casadi_int k=0; k<max_soc_; ++k) {
+              m->n_soc++;
+              // Shift the linearized constraints by g(x+dx_soc) - J*dx_soc
+              casadi_fill(m->g_soc, ng_, 0.);
+              casadi_mv(m->Jk, Asp_, m->dx_soc, m->g_soc, false);
+              casadi_scal(ng_, -1., m->g_soc);
+              casadi_axpy(ng_, 1., m->g_cand, m->g_soc);
+              casadi_copy(m->lbg, ng_, m->qp_LBA);
+              casadi_axpy(ng_, -1., m->g_soc, m->qp_LBA);
+              casadi_copy(m->ubg, ng_, m->qp_UBA);
+              casadi_axpy(ng_, -1., m->g_soc, m->qp_UBA);
+              solve_QP(m, m->Bk, m->gf, m->qp_LBX, m->qp_UBX, m->Jk, m->qp_LBA,
+                       m->qp_UBA, m->dx_soc, m->lam_x_soc, m->lam_a_soc);
+              // Evaluate the corrected candidate
+              casadi_copy(m->x, nx_, m->x_cand);
+              casadi_axpy(nx_, 1., m->dx_soc, m->x_cand);
+              m->arg[0] = m->x_cand;
+              m->arg[1] = m->p;
+              m->res[0] = &fk_cand;
+              m->res[1] = m->g_cand;
+              if (calc_function(m, "nlp_fg")) break;
+              double theta_soc = std::fmax(casadi_max_viol(nx_, m->x_cand, m->lbx, m->ubx),
+                                           casadi_max_viol(ng_, m->g_cand, m->lbg, m->ubg));
+              if (acceptable(1., fk_cand, theta_soc)) {
+                soc_accepted = true;
+                break;
+              }
+              // Stop if the infeasibility is not reduced sufficiently
+              if (theta_soc > kappa_soc*theta_cand) break;
+              theta_cand = theta_soc;
+            }
+            if (soc_accepted) {
+              // Replace the step with the corrected step
+              casadi_copy(m->dx_soc, nx_, m->dx);
+              casadi_copy(m->lam_x_soc, nx_, m->qp_DUAL_X);
+              casadi_copy(m->lam_a_soc, ng_, m->qp_DUAL_A);
+              break;
+            }
           }
 
           // Line-search not successful, but we accept it.
@@ -516,6 +688,20 @@ namespace casadi {
           t = beta_ * t;
         }
 
+        // Augment the filter unless the objective was reduced sufficiently
+        if (filter_ && !f_type(t)) {
+          double theta_new = (1-gamma_theta)*l1_infeas, f_new = m->f - gamma_f*l1_infeas;
+          auto it = m->filter.begin();
+          while (it!=m->filter.end()) {
+            if (it->first >= theta_new && it->second >= f_new) {
+              it = m->filter.erase(it);
+            } else {
+              ++it;
+            }
+          }
+          m->filter.push_back(make_pair(theta_new, f_new));
+        }
+
         // Candidate accepted, update dual variables
         casadi_scal(ng_, 1-t, m->lam_g);
         casadi_axpy(ng_, t, m->qp_DUAL_A, m->lam_g);
@@ -555,7 +741,7 @@ namespace casadi {
                                   casadi_int ls_trials, bool ls_success) const {
     print("%4d %14.6e %9.2e %9.2e %9.2e ", iter, obj, pr_inf, du_inf, dx_norm);
     if (rg>0) {
-      print("%7.2d ", log10(rg));
+      print("%7.2f ", log10(rg));
     } else {
       print("%7s ", "-");
     }
@@ -588,6 +774,7 @@ namespace casadi {
     m->res[CONIC_LAM_A] = lambda_A_opt;
 
     // Solve the QP
+    m->n_qp++;
     qpsol_(m->arg, m->res, m->iw, m->w, 0);
     if (verbose_) print("QP solved\n");
   }
@@ -597,6 +784,9 @@ namespace casadi {
     auto m = static_cast<SqpmethodMemory*>(mem);
     stats["return_status"] = m->return_status;
     stats["iter_count"] = m->iter_count;
+    stats["n_ls"] = m->n_ls;
+    stats["n_qp"] = m->n_qp;
+    stats["n_soc"] = m->n_soc;
     return stats;
   }
 } // namespace casadi
@@ -63,6 +63,9 @@ namespace casadi {
     /// Current Hessian approximation
     double *Bk;
 
+    // Second-order correction step, its multipliers and constraint shift
+    double *dx_soc, *lam_x_soc, *lam_a_soc, *g_soc;
+
     /// Hessian regularization
     double reg;
 
@@ -73,6 +76,13 @@ namespace casadi {
     double* merit_mem;
     size_t merit_ind;
 
+    // Filter entries (infeasibility, objective) and infeasibility limits
+    std::vector<std::pair<double, double> > filter;
+    double theta_max, theta_min;
+
+    // Number of line-search trials, QPs solved and second-order corrections
+    casadi_int n_ls, n_qp, n_soc;
+
     /// Last return status
     const char* return_status;
 
@@ -149,6 +159,8 @@ namespace casadi {
     double beta_;
     casadi_int max_iter_ls_;
     casadi_int merit_memsize_;
+    bool filter_;
+    casadi_int max_soc_;
     ///@}
 
     // Print options
@@ -157,12 +169,19 @@ namespace casadi {
     // Hessian sparsity
     Sparsity Hsp_;
 
+    // Diagonal block of the Hessian for each variable, number of blocks
+    std::vector<casadi_int> blk_;
+    casadi_int nblk_;
+
     // Jacobian sparsity
     Sparsity Asp_;
 
     /// Regularization
     bool regularize_;
 
+    /// Evaluate all derivative information with one function
+    bool combined_oracle_;
+
     /// Access Conic
     const Function getConic() const { return qpsol_;}
 
@@ -0,0 +1,75 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+/**
+Measures how concurrent model construction scales with the number of threads.
+Every thread does the same amount of work: it creates sparsity patterns, which
+go through the shared sparsity cache, and builds and evaluates small SX and MX
+functions. With little contention, the throughput grows with the number of
+threads up to the number of cores.
+*/
+
+#include "casadi/casadi.hpp"
+#include <thread>
+#include <chrono>
+
+using namespace casadi;
+using namespace std;
+
+// Number of models built by each thread
+const casadi_int n_model = 200;
+
+// Build and evaluate models of different sizes
+double build_models(casadi_int k) {
+  double r = 0;
+  for (casadi_int i=0; i<n_model; ++i) {
+    casadi_int n = 1 + (i+k)%20;
+    SX x = SX::sym("x", n);
+    SX p = SX::sym("p", Sparsity::lower(n));
+    SX e = mtimes(p, sin(x)) + x;
+    Function f("f", {x, p}, {e, jacobian(e, x)});
+    MX y = MX::sym("y", n);
+    Function F("F", {y}, {f(vector<MX>{y, MX::ones(Sparsity::lower(n))}).at(0)});
+    r += static_cast<double>(dot(F(DM::ones(n)).at(0), DM::ones(n)));
+  }
+  return r;
+}
+
+int main() {
+  casadi_int max_threads = max(4u, 2*thread::hardware_concurrency());
+  double t1 = 0;
+  for (casadi_int nt=1; nt<=max_threads; nt*=2) {
+    vector<double> res(nt);
+    auto start = chrono::steady_clock::now();
+    vector<thread> th;
+    for (casadi_int k=0; k<nt; ++k) th.emplace_back([&res, k]() { res[k] = build_models(k);});
+    for (auto&& t : th) t.join();
+    double t = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    if (nt==1) t1 = t;
+    cout << nt << " threads: " << t << " s, " << nt*n_model/t << " models/s, "
+         << "speedup " << nt*t1/t << endl;
+  }
+  return 0;
+}
@@ -0,0 +1,172 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+/**
+Checks the .nl reader on the same small problem in ASCII and binary form,
+with and without expansion to SX. The problem uses a defined variable,
+if-then-else, n-ary min/max, a sum and a piecewise linear term:
+
+  minimize   x0^2 - 2 x0 + 1 + (x1-2)^2 + max(x1-3, 0)
+  subject to if x0>=0 then x0 else -x0 <= 0.5
+             max(x0, x1, 0.5) <= 2
+             min(x0, x1, 3) >= 0
+             x0 - x1 == -1
+             -10 <= x0 <= 10
+
+with the solution x = (0.5, 1.5), f = 0.5.
+*/
+
+#include "casadi/casadi.hpp"
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+
+using namespace casadi;
+using namespace std;
+
+// Report a failed check
+#define CHECK(cond) \
+  if (!(cond)) { \
+    cerr << "Check failed on line " << __LINE__ << ": " #cond << endl; \
+    return 1; \
+  }
+
+// Objective and constraints of an imported problem as a function of x
+Function nlp_fcn(const NlpBuilder& nl) {
+  return Function("nlp", {vertcat(nl.x)}, {nl.f, vertcat(nl.g)});
+}
+
+// Reference objective and constraints
+vector<double> ref(double x0, double x1) {
+  return {x0*x0 - 2*x0 + 1 + (x1-2)*(x1-2) + std::fmax(x1-3, 0.),
+          x0>=0 ? x0 : -x0, std::fmax(std::fmax(x0, x1), 0.5),
+          std::fmin(std::fmin(x0, x1), 3.), x0-x1};
+}
+
+// Does importing a file fail with a message containing msg
+bool import_fails(const string& filename, const string& msg) {
+  try {
+    NlpBuilder nl;
+    nl.import_nl(filename);
+  } catch (exception& e) {
+    return string(e.what()).find(msg)!=string::npos;
+  }
+  return false;
+}
+
+int main(int argc, char *argv[]) {
+  // Directory with the problems
+  string dir = (argc==2) ? argv[1] : "../docs/examples/nl_files/";
+
+  for (string file : {"nl_ops.nl", "nl_ops_binary.nl"}) {
+    NlpBuilder nl[2];
+    Function fcn[2];
+    for (bool expand : {false, true}) {
+      NlpBuilder& n = nl[expand];
+      n.import_nl(dir + file, {{"expand", expand}});
+
+      // Bounds and initial guess
+      CHECK(n.x.size()==2 && n.g.size()==4);
+      CHECK(n.x_lb==vector<double>({-10, -inf}) && n.x_ub==vector<double>({10, inf}));
+      CHECK(n.g_lb==vector<double>({-inf, -inf, 0, -1}));
+      CHECK(n.g_ub==vector<double>({0.5, 2, inf, -1}));
+      CHECK(n.x_init==vector<double>({0.2, 0.2}));
+      fcn[expand] = nlp_fcn(n);
+      CHECK(fcn[expand].is_a("MXFunction"));
+    }
+    // The expanded problem is a single call to an SX Function
+    CHECK(!nl[0].f.is_output() && nl[1].f.is_output());
+    CHECK(nl[1].f.dep().is_call() && nl[1].f.dep().which_function().is_a("SXFunction"));
+
+    // Both branches of the if-then-else, the kink of the piecewise linear term
+    vector<vector<double>> points = {{-0.7, 3.5}, {2, -1}, {0.3, 3}, {0, 0}, {0.5, 1.5}};
+    for (auto&& x : points) {
+      vector<double> r = ref(x[0], x[1]);
+      for (bool expand : {false, true}) {
+        vector<DM> res = fcn[expand](vector<DM>{DM(x)});
+        CHECK(fabs(double(res[0])-r[0])<1e-12);
+        for (casadi_int i=0; i<4; ++i) CHECK(fabs(double(res[1](i))-r[i+1])<1e-12);
+      }
+    }
+
+    // Known solution
+    for (bool expand : {false, true}) {
+      NlpBuilder& n = nl[expand];
+      Function solver = nlpsol("solver", "sqpmethod", n,
+                               {{"qpsol", "qrqp"}, {"print_header", false},
+                                {"print_iteration", false}, {"print_time", false},
+                                {"qpsol_options", Dict{{"print_iter", false},
+                                                       {"print_header", false}}}});
+      DMDict res = solver(DMDict{{"x0", n.x_init}, {"lbx", n.x_lb}, {"ubx", n.x_ub},
+                                 {"lbg", n.g_lb}, {"ubg", n.g_ub}});
+      CHECK(solver.stats().at("success").to_bool());
+      CHECK(double(norm_inf(res["x"]-DM(vector<double>{0.5, 1.5})))<1e-8);
+      CHECK(fabs(double(res["f"])-0.5)<1e-8);
+    }
+  }
+
+  // Deeply nested expression: x0 + (x0 + (... + x0))
+  {
+    casadi_int depth = 100000;
+    string filename = temporary_file("test_nl_reader", ".nl");
+    {
+      ofstream f(filename);
+      f << "g3 1 1 0\n 1 0 1 0 0\n 0 1\n 0 0\n 0 1 0\n 0 0 0 1\n 0 0 0 0 0\n 0 1\n 0 0\n"
+        << " 0 0 0 0 0\nO0 0\n";
+      for (casadi_int k=0; k<depth; ++k) f << "o0\nv0\n";
+      f << "v0\nG0 1\n0 0\n";
+    }
+    for (bool expand : {false, true}) {
+      NlpBuilder nl;
+      nl.import_nl(filename, {{"expand", expand}});
+      DM f = nlp_fcn(nl)(vector<DM>{2})[0];
+      CHECK(double(f)==2*(depth+1));
+    }
+    remove(filename.c_str());
+  }
+
+  // Truncated files
+  for (string file : {"nl_ops.nl", "nl_ops_binary.nl"}) {
+    vector<char> buf;
+    {
+      ifstream f(dir + file, ifstream::binary);
+      buf.assign(istreambuf_iterator<char>(f), istreambuf_iterator<char>());
+    }
+    // Cut the file in the objective, after the first number (ASCII) or inside it (binary)
+    string s(buf.begin(), buf.end());
+    size_t pos = s.find('n', s.find('O'));
+    CHECK(pos!=string::npos);
+    string filename = temporary_file("test_nl_reader", ".nl");
+    {
+      ofstream f(filename, ofstream::binary);
+      f.write(buf.data(), pos + 3);
+    }
+    CHECK(import_fails(filename, "Unexpected end of file"));
+    remove(filename.c_str());
+  }
+
+  cout << "NL reader checks successful" << endl;
+  return 0;
+}
@@ -0,0 +1,113 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+/**
+Constructs, evaluates and destroys expression graphs in many threads at once.
+The graphs share cached constants and many common subexpressions, which are
+released simultaneously by threads other than the ones that built them.
+*/
+
+#include "casadi/casadi.hpp"
+#include <thread>
+#include <atomic>
+
+using namespace casadi;
+using namespace std;
+
+// Number of threads
+const casadi_int N = 32;
+
+// Number of shared subexpressions
+const casadi_int n_shared = 2000;
+
+// Expression graph referencing each shared subexpression once
+SX build_expr(const SX& x, const vector<SX>& s, casadi_int k) {
+  SX e = 0;
+  for (casadi_int j=0; j<s.size(); ++j) e += s[j]*(0.5*k+1);
+  return e;
+}
+
+// Evaluate SX and MX functions built from an expression
+double evaluate(const SX& x, const SX& e, casadi_int k) {
+  Function f("f", {x}, {e, jacobian(e, x)});
+  MX y = MX::sym("y");
+  Function F("F", {y}, {3*f(vector<MX>{y}).at(0) + f(vector<MX>{y}).at(1)});
+  return static_cast<double>(F(DM(0.1*k)).at(0));
+}
+
+int main() {
+  SX x = SX::sym("x");
+
+  // Serial reference
+  vector<double> ref(N);
+  {
+    vector<SX> s(n_shared);
+    for (casadi_int j=0; j<n_shared; ++j) s[j] = sin(x+j);
+    for (casadi_int k=0; k<N; ++k) ref[k] = evaluate(x, build_expr(x, s, k), k);
+  }
+
+  for (casadi_int round=0; round<20; ++round) {
+    vector<SX> expr(N);
+    vector<double> res(N);
+    {
+      // Shared subexpressions, only referenced by the threads' graphs after this scope
+      vector<SX> s(n_shared);
+      for (casadi_int j=0; j<n_shared; ++j) s[j] = sin(x+j);
+      vector<thread> th;
+      for (casadi_int k=0; k<N; ++k) {
+        th.emplace_back([&, k]() {
+          expr[k] = build_expr(x, s, k);
+          if (round==0) res[k] = evaluate(x, expr[k], k);
+        });
+      }
+      for (auto&& t : th) t.join();
+    }
+
+    // Compare with the serial reference
+    if (round==0) {
+      for (casadi_int k=0; k<N; ++k) {
+        if (res[k]!=ref[k]) {
+          cerr << "Mismatch for thread " << k << endl;
+          return 1;
+        }
+      }
+    }
+
+    // Free the graphs simultaneously, in threads that did not build them
+    atomic<casadi_int> n_ready(0);
+    vector<thread> th;
+    for (casadi_int k=0; k<N; ++k) {
+      th.emplace_back([&, k]() {
+        n_ready++;
+        while (n_ready<N) this_thread::yield();
+        expr[(k+1) % N] = SX();
+      });
+    }
+    for (auto&& t : th) t.join();
+  }
+
+  cout << "Threaded construction successful" << endl;
+  return 0;
+}
@@ -0,0 +1,142 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+/**
+Checks the streaming XML reader used by DaeBuilder::parse_fmi on small documents
+with comments, CDATA sections, entity references and self-closing tags.
+*/
+
+#include "casadi/casadi.hpp"
+#include "casadi/core/xml_reader.hpp"
+#include <cstdio>
+#include <fstream>
+
+using namespace casadi;
+using namespace std;
+
+// Write a document to a temporary file
+string write_doc(const string& doc) {
+  string filename = temporary_file("test_xml_reader", ".xml");
+  ofstream f(filename);
+  f << doc;
+  return filename;
+}
+
+// Report a failed check
+#define CHECK(cond) \
+  if (!(cond)) { \
+    cerr << "Check failed on line " << __LINE__ << ": " #cond << endl; \
+    return 1; \
+  }
+
+int main() {
+  string doc =
+    "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+    "<!DOCTYPE model>\n"
+    "<!-- A comment with a <tag> inside -->\n"
+    "<model name=\"a &amp; b\" quote='&quot;&lt;&gt;&apos;'>\n"
+    "  <empty/>\n"
+    "  <var id=\"x\" value=\"&#65;&#x42;\" />\n"
+    "  <text>  1 &lt; 2 <!-- skipped --> </text>\n"
+    "  <cdata><![CDATA[ <not a tag> & ]]></cdata>\n"
+    "  <blank><![CDATA[]]><![CDATA[   ]]></blank>\n"
+    "  <outer><inner>3</inner><inner2/></outer>\n"
+    "</model>\n";
+  string filename = write_doc(doc);
+
+  // Sequence of tags
+  {
+    XmlReader xml(filename);
+    vector<string> tags;
+    while (xml.next()) {
+      tags.push_back((xml.is_start() ? "+" : "-") + str(xml.depth()));
+      if (xml.is_start()) tags.back() += xml.node().name();
+    }
+    vector<string> ref = {"+0model", "+1empty", "-1", "+1var", "-1", "+1text", "-1",
+                          "+1cdata", "-1", "+1blank", "-1", "+1outer", "+2inner", "-2",
+                          "+2inner2", "-2", "-1", "-0"};
+    CHECK(tags==ref);
+  }
+
+  // Attributes, text and subtrees
+  {
+    XmlReader xml(filename);
+    CHECK(xml.next() && xml.is_start());
+    CHECK(xml.node().getAttribute("name")=="a & b");
+    CHECK(xml.node().getAttribute("quote")=="\"<>'");
+    XmlNode model = xml.read_node();
+    CHECK(!xml.is_start() && xml.depth()==0);
+    CHECK(!xml.next());
+    CHECK(model.size()==6);
+    CHECK(model["empty"].size()==0 && model["empty"].getText().empty());
+    CHECK(model["var"].getAttribute("value")=="AB");
+    CHECK(model["text"].getText()=="1 < 2");
+    CHECK(model["cdata"].getText()=="<not a tag> &");
+    CHECK(model["blank"].getText().empty());
+    CHECK(model["outer"].size()==2);
+    CHECK(model["outer"]["inner"].getText()=="3");
+  }
+  remove(filename.c_str());
+
+  // Unexpected end of document
+  {
+    string filename = write_doc("<model><var id=\"x\">");
+    XmlReader xml(filename);
+    CHECK(xml.next() && xml.next());
+    bool failed = false;
+    try {
+      xml.read_node();
+    } catch (exception& e) {
+      failed = string(e.what()).find("Unexpected end of document in <var>")!=string::npos;
+    }
+    CHECK(failed);
+    XmlReader xml2(filename);
+    failed = false;
+    try {
+      while (xml2.next()) {}
+    } catch (exception& e) {
+      failed = string(e.what()).find("Unexpected end of document")!=string::npos;
+    }
+    CHECK(failed);
+    remove(filename.c_str());
+  }
+
+  // Mismatched end tag
+  {
+    string filename = write_doc("<model><var></model>");
+    XmlReader xml(filename);
+    bool failed = false;
+    try {
+      while (xml.next()) {}
+    } catch (exception& e) {
+      failed = string(e.what()).find("Unexpected end tag </model>")!=string::npos;
+    }
+    CHECK(failed);
+    remove(filename.c_str());
+  }
+
+  cout << "XML reader checks successful" << endl;
+  return 0;
+}
@@ -0,0 +1,79 @@
+g3 1 1 0	# problem nl_ops
+ 2 4 1 0 1	# vars, constraints, objectives, ranges, eqns
+ 3 1	# nonlinear constraints, objectives
+ 0 0	# network constraints: nonlinear, linear
+ 2 2 2	# nonlinear vars in constraints, objectives, both
+ 0 0 0 1	# linear network variables; functions; arith, flags
+ 0 0 0 0 0	# discrete variables: binary, integer, nonlinear (b,c,o)
+ 8 2	# nonzeros in Jacobian, gradients
+ 0 0	# max name lengths: constraints, variables
+ 0 1 0 0 0	# common exprs: b,c,o,c1,o1
+V2 0 0	#x1 - 2
+o1	#-
+v1	#x[2]
+n2
+C0	#if x[1] >= 0 then x[1] else -x[1]
+o35	#if
+o28	#>=
+v0	#x[1]
+n0
+v0	#x[1]
+o16	#-
+v0	#x[1]
+C1	#max(x[1], x[2], 0.5)
+o12	#max
+3
+v0	#x[1]
+v1	#x[2]
+n0.5
+C2	#min(x[1], x[2], 3)
+o11	#min
+3
+v0	#x[1]
+v1	#x[2]
+n3
+C3	#x[1] - x[2]
+n0
+O0 0	#x[1]^2 + 1 + (x[2] - 2)^2 + <<3; 0, 1>> x[2]
+o54	#sumlist
+4
+o5	#^
+v0	#x[1]
+n2
+n1
+o5	#^
+v2	#x[2] - 2
+n2
+o64	#plterm
+2
+n0
+n3
+n1
+v1	#x[2]
+x2	# initial guess
+0 0.2
+1 0.2
+r	#4 ranges (rhs's)
+1 0.5
+1 2
+2 0
+4 -1
+b	#2 bounds (on variables)
+0 -10 10
+3
+k1	#intermediate Jacobian column lengths
+4
+J0 1
+0 0
+J1 2
+0 0
+1 0
+J2 2
+0 0
+1 0
+J3 2
+0 1
+1 -1
+G0 2
+0 -2
+1 0
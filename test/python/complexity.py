@@ -29,6 +29,8 @@ from types import *
 from helpers import *
 from time import time
 import sys
+import os
+import tempfile
 from scipy import linalg, std, mean
 from scipy.stats import t
 
@@ -205,6 +207,118 @@ class ComplexityTests(casadiTestCase):
 
     self.complexity(setupfun,fun, 1)
 
+  def test_sparsity_cache(self):
+    self.message("Sparsity pattern creation")
+    def setupfun(self,N):
+      return {}
+    def fun(self,N,setup):
+      for i in range(N):
+        Sparsity.banded(i%97+3, 1)
+        Sparsity(i+5, 3)
+
+    self.complexity(setupfun,fun, 1)
+
+  def test_SX_graph(self):
+    self.message("SX graph construction and destruction")
+    def setupfun(self,N):
+      return {'x': SX.sym("x"), 'y': SX.sym("y")}
+    def fun(self,N,setup):
+      x = setup['x']
+      y = setup['y']
+      e = x
+      for i in range(N):
+        e = sin(e)*y + e
+      del e
+
+    self.complexity(setupfun,fun, 1)
+
+  def test_SX_chain(self):
+    self.message("SX deep chain construction")
+    def setupfun(self,N):
+      return {'x': SX.sym("x")}
+    def fun(self,N,setup):
+      e = setup['x']
+      for i in range(10000*N):
+        e = sin(e)*e
+
+    self.complexity(setupfun,fun, 1)
+
+    self.message("SX deep chain printing")
+    def setupfun(self,N):
+      x = SX.sym("x")
+      e = x
+      for i in range(10000*N):
+        e = sin(e)*e
+      return {'x': x, 'e': e}
+    def fun(self,N,setup):
+      s = str(setup['e'])
+      self.assertTrue(s.endswith(", (sin(@%d)*@%d)" % (10000*N-1, 10000*N-1)))
+
+    self.complexity(setupfun,fun, 1)
+
+    self.message("SX deep chain function")
+    def fun(self,N,setup):
+      Function('f', [setup['x']], [setup['e']])
+
+    self.complexity(setupfun,fun, 1)
+
+  def test_MX_chain(self):
+    self.message("MX deep chain construction")
+    def setupfun(self,N):
+      return {'x': MX.sym("x")}
+    def fun(self,N,setup):
+      e = setup['x']
+      for i in range(10000*N):
+        e = sin(e)*e
+
+    self.complexity(setupfun,fun, 1)
+
+    self.message("MX deep chain printing")
+    def setupfun(self,N):
+      x = MX.sym("x")
+      e = x
+      for i in range(10000*N):
+        e = sin(e)*e
+      return {'x': x, 'e': e}
+    def fun(self,N,setup):
+      s = str(setup['e'])
+      self.assertTrue(s.endswith(", (sin(@%d)*@%d)" % (10000*N-1, 10000*N-1)))
+
+    self.complexity(setupfun,fun, 1)
+
+    self.message("MX deep chain function")
+    def fun(self,N,setup):
+      Function('f', [setup['x']], [setup['e']])
+
+    self.complexity(setupfun,fun, 1)
+
+  def test_parse_fmi(self):
+    self.message("Model description parsing")
+    def setupfun(self,N):
+      var = ('<ScalarVariable name="x%d" valueReference="%d" variability="continuous" '
+             'causality="internal" alias="noAlias"><Real start="1.0"/>'
+             '<QualifiedName><exp:QualifiedNamePart name="x%d"/></QualifiedName>'
+             '<VariableCategory>state</VariableCategory></ScalarVariable>\n')
+      idf = '<exp:Identifier><exp:QualifiedNamePart name="x%d"/></exp:Identifier>'
+      eq = ('<equ:Equation><exp:Sub><exp:Der>' + idf + '</exp:Der><exp:Mul>'
+            '<exp:RealLiteral>0.5</exp:RealLiteral><exp:Sin>' + idf + '</exp:Sin>'
+            '</exp:Mul></exp:Sub></equ:Equation>\n')
+      fd, filename = tempfile.mkstemp(suffix=".xml")
+      with os.fdopen(fd, "w") as f:
+        f.write('<?xml version="1.0" encoding="UTF-8"?>\n<fmiModelDescription>\n')
+        f.write('<ModelVariables>\n')
+        for i in range(N): f.write(var % (i, i, i))
+        f.write('</ModelVariables>\n<equ:DynamicEquations>\n')
+        for i in range(N): f.write(eq % (i, (i+1)%N))
+        f.write('</equ:DynamicEquations>\n</fmiModelDescription>\n')
+      return {'filename': filename}
+    def fun(self,N,setup):
+      dae = DaeBuilder()
+      dae.parse_fmi(setup['filename'])
+      self.assertEqual(len(dae.dae), N)
+
+    self.complexity(setupfun,fun, 1)
+
 
   def test_MX_funprodvec(self):
     self.message("MX prod")
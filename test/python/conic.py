@@ -66,6 +66,12 @@ if has_conic("clp"):
 if has_conic("qrqp"):
   conics.append(("qrqp",dict(max_iter=20),{"quadratic": True, "dual": True, "soc": False}))
 
+if has_conic("ipqp"):
+  conics.append(("ipqp",dict(print_iter=False,tol=1e-12),{"quadratic": True, "dual": True, "soc": False}))
+
+if has_conic("riccati"):
+  conics.append(("riccati",dict(print_iter=False,tol=1e-12),{"quadratic": True, "dual": True, "soc": False}))
+
 print(conics)
 
 class ConicTests(casadiTestCase):
@@ -775,6 +781,58 @@ class ConicTests(casadiTestCase):
     self.checkarray(sol_ref["lam_x"], sol["lam_x"],digits=8)
     self.checkarray(sol_ref["f"], sol["f"])
 
+  @requires_conic("riccati")
+  @requires_conic("qrqp")
+  def test_riccati(self):
+    N = 20
+    nx = 2
+    nu = 1
+    Ad = DM([[1, 0.1],[-0.1, 0.95]])
+    Bd = DM([0.02, 0.1])
+
+    X = [MX.sym("x"+str(k), nx) for k in range(N+1)]
+    U = [MX.sym("u"+str(k), nu) for k in range(N)]
+    w = []
+    lbw = []
+    ubw = []
+    g = []
+    J = 0
+    for k in range(N):
+      w += [X[k], U[k]]
+      lbw += [1, 0] if k==0 else [-inf, -2]
+      ubw += [1, 0] if k==0 else [inf, 0.5]
+      lbw += [-0.3]
+      ubw += [0.3]
+      J += sumsqr(X[k]) + 0.1*sumsqr(U[k]) + 0.1*X[k][0]*U[k]
+      g += [mtimes(Ad, X[k]) + mtimes(Bd, U[k]) - X[k+1], X[k][0]+U[k]]
+    w += [X[N]]
+    lbw += [-inf, -inf]
+    ubw += [inf, inf]
+    J += 10*sumsqr(X[N])
+    lbg = [0, 0, -inf]*N
+    ubg = [0, 0, 0.8]*N
+
+    prob = {'f': J, 'x': vertcat(*w), 'g': vertcat(*g)}
+    solver_ref = qpsol('solver', 'qrqp', prob, {"print_iter": False})
+    solver = qpsol('solver', 'riccati', prob, {"print_iter": False, "tol": 1e-12})
+
+    sol_ref = solver_ref(lbx=lbw, ubx=ubw, lbg=lbg, ubg=ubg)
+    sol = solver(lbx=lbw, ubx=ubw, lbg=lbg, ubg=ubg)
+    self.assertTrue(solver.stats()["success"])
+
+    self.checkarray(sol_ref["x"], sol["x"], digits=7)
+    self.checkarray(sol_ref["lam_g"], sol["lam_g"], digits=6)
+    self.checkarray(sol_ref["lam_x"], sol["lam_x"], digits=6)
+    self.checkarray(sol_ref["f"], sol["f"], digits=7)
+
+    # Stages are also found with all states ordered before all controls
+    p = [k*(nx+nu)+i for k in range(N+1) for i in range(nx)] + [k*(nx+nu)+nx+i for k in range(N) for i in range(nu)]
+    prob = {'f': J, 'x': vertcat(*(X+U)), 'g': vertcat(*g)}
+    solver = qpsol('solver', 'riccati', prob, {"print_iter": False, "tol": 1e-12})
+    sol = solver(lbx=DM(lbw)[p], ubx=DM(ubw)[p], lbg=lbg, ubg=ubg)
+    self.checkarray(sol_ref["x"][p], sol["x"], digits=7)
+    self.checkarray(sol_ref["lam_g"], sol["lam_g"], digits=6)
+
   @requires_conic("hpmpc")
   @requires_conic("qpoases")
   def test_hpmc_timevarying(self):
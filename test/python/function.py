@@ -562,6 +562,32 @@ class Functiontests(casadiTestCase):
     self.checkfunction_light(fun.map(4,"thread",2),fun.map(4),inputs=[hcat(X_[:4]),hcat(Y_[:4]),hcat(Z_[:4]),hcat(V_[:4])])
     self.checkfunction_light(fun.map(4,"thread",5),fun.map(4),inputs=[hcat(X_[:4]),hcat(Y_[:4]),hcat(Z_[:4]),hcat(V_[:4])])
 
+  def test_parallel_calls(self):
+    x = SX.sym("x")
+    y = SX.sym("y",2)
+    fun = Function("f",[x,y],[mtimes(y,y.T)*x,sin(y*x)])
+
+    p = MX.sym("p")
+    q = MX.sym("q",2)
+    # Independent calls, followed by a call depending on them
+    r = [fun(p*i,q+i) for i in range(4)]
+    s = fun(r[0][1][0],r[1][1]+r[2][1]+r[3][1])
+    out = [s[0],vertcat(*[e[1] for e in r])]
+
+    F = Function("F",[p,q],out)
+    # At least two threads, also on single core machines
+    for opts in [{"parallel":True},{"parallel":True,"live_variables":True},
+                 {"parallel":True,"parallel_threads":2},{"parallel":True,"parallel_threads":3}]:
+      Fp = Function("F",[p,q],out,opts)
+      # The worker threads are reused between evaluations
+      for k in range(3):
+        self.checkfunction_light(Fp,F,inputs=[0.3+k,DM([0.1,0.7])])
+
+      # Parallel calls of a function evaluated in parallel
+      G = Function("G",[p,q],[Fp(p,q)[0]+Fp(2*p,q)[0]])
+      Gp = Function("G",[p,q],[Fp(p,q)[0]+Fp(2*p,q)[0]],opts)
+      self.checkfunction_light(Gp,G,inputs=[0.3,DM([0.1,0.7])])
+
   @memory_heavy()
   def test_mapsum(self):
     x = SX.sym("x")
@@ -1678,6 +1704,34 @@ class Functiontests(casadiTestCase):
     self.check_codegen(f,inputs=[np.random.random((3,3))])
     self.check_codegen(f,inputs=[np.random.random((3,3))], opts={"avoid_stack": True})
 
+  def test_codegen_avoid_stack_linsol(self):
+    A = MX.sym("A",3,3)
+    b = MX.sym("b",3)
+    np.random.seed(0)
+    A_ = np.random.random((3,3))+3*np.eye(3)
+    for s in ["qr","ldl"]:
+      if s=="ldl":
+        f = Function('f',[A,b],[solve(A+A.T,b,s),b[0]*2])
+      else:
+        f = Function('f',[A,b],[solve(A,b,s),b[0]*2])
+      self.check_codegen(f,inputs=[A_,np.random.random(3)])
+      self.check_codegen(f,inputs=[A_,np.random.random(3)], opts={"avoid_stack": True})
+
+
+  def test_codegen_unroll(self):
+    A = MX.sym("A",Sparsity.lower(3))
+    B = MX.sym("B",3,2)
+    x = MX.sym("x",3)
+    y = MX.sym("y",3)
+    np.random.seed(0)
+    A_ = sparsify(DM(np.tril(np.random.random((3,3))))+3*DM.eye(3))
+    inputs = [A_,np.random.random((3,2)),np.random.random(3),np.random.random(3)]
+    f = Function('f',[A,B,x,y],[mtimes(A,B),mtimes(A.T,B),mtimes(A,x),bilin(A,x,y),
+                                rank1(A,0.3,x,y),project(A,Sparsity.diag(3)),
+                                solve(A+A.T,x,"ldl")])
+    for limit in [0,1,10,1000]:
+      for avoid_stack in [False,True]:
+        self.check_codegen(f,inputs=inputs, opts={"unroll_limit": limit, "avoid_stack": avoid_stack})
 
   def test_sx_serialize(self):
     x = SX.sym("x")
@@ -41,6 +41,7 @@ except:
   pass
 try:
   solvers.append(("newton",{},[]))
+  solvers.append(("newton",{"reuse_jacobian":3,"line_search":True},[]))
 except:
   pass
 
@@ -96,6 +97,18 @@ class ImplicitFunctiontests(casadiTestCase):
           self.checkfunction(solver,refsol,inputs=solver_in,digits=10)
       if "codegen" in features: self.check_codegen(solver,inputs=solver_in)
 
+  def test_fast_newton_codegen(self):
+    # Several iterations, the iterate must not be overwritten by the Jacobian
+    x=SX.sym("x",2)
+    p=SX.sym("p")
+    f=Function("f", [x,p],[vertcat(x[0]**2+x[1]-p, x[0]-x[1]**3+1)])
+    solver=rootfinder("solver", "fast_newton", f, {"max_iter": 20})
+    solver_in = [DM([1,1]), 3]
+    sol = solver(*solver_in)
+    self.checkarray(f(sol, 3), DM.zeros(2), digits=10)
+    self.check_codegen(solver,inputs=solver_in)
+    self.check_codegen(solver,inputs=solver_in,opts={"avoid_stack": True})
+
   def test_missing_symbols(self):
     for Solver, options, features in solvers:
       self.message(Solver)
@@ -286,6 +299,28 @@ class ImplicitFunctiontests(casadiTestCase):
     a = SX.sym("a",2)
     f = Function("f", [x,a],[tan(x)-a,sqrt(a)*x**2 ])
 
+  def test_newton_reuse(self):
+    x = SX.sym("x",10)
+    p = SX.sym("p")
+    g = x-1-0.1*(sin(x)*p+exp(-x))
+    f = Function("f",[x,p],[g])
+    ref = rootfinder("ref","newton",f,{"linear_solver":"csparse"})
+    ref_out = ref(0,0.3)
+    for opts in [{"reuse_jacobian":20}, {"reuse_jacobian":20, "line_search":True}]:
+      opts["linear_solver"] = "csparse"
+      solver = rootfinder("solver","newton",f,opts)
+      self.checkarray(solver(0,0.3),ref_out,digits=10)
+      stats = solver.stats()
+      self.assertTrue(stats["success"])
+      self.assertEqual(stats["n_fact"],1)
+      self.assertTrue(stats["iter_count"]>ref.stats()["iter_count"])
+
+    # Full Newton steps diverge for atan
+    x = SX.sym("x")
+    solver = rootfinder("solver","newton",{'x':x, 'g':atan(x)},{"line_search":True})
+    self.checkarray(solver(x0=3)["x"],0,digits=10)
+    self.assertTrue(solver.stats()["n_backtrack"]>0)
+
   def test_no_success(self):
 
     x=SX.sym("x")
@@ -347,6 +347,29 @@ class Misctests(casadiTestCase):
 
     assert "casadi_nlpsol_foo" in result[1]
 
+  def test_threaded_construction(self):
+    import threading
+
+    def build(k, res):
+      # Independent models sharing only cached constants and sparsity patterns
+      x = SX.sym("x", 3)
+      e = x
+      for i in range(50):
+        e = sin(e)*0.5 + vertcat(x[1:], 2.5*x[0]) + 1.5
+      f = Function('f', [x], [e, jacobian(e, x)])
+      y = MX.sym("y", 3)
+      F = Function('F', [y], [f(y)[0]*3])
+      res[k] = F(DM([0.1*k, 1, 2]))
+
+    N = 32
+    res = [None]*N
+    threads = [threading.Thread(target=build, args=(k, res)) for k in range(N)]
+    for t in threads: t.start()
+    for t in threads: t.join()
+    ref = [None]*N
+    for k in range(N): build(k, ref)
+    for k in range(N):
+      self.checkarray(res[k], ref[k])
 
 if __name__ == '__main__':
     unittest.main()
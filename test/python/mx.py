@@ -2638,6 +2638,51 @@ class MXtests(casadiTestCase):
           f = Function('f',[M,Y],[e])
           self.checkfunction(f,f.expand(),inputs=[ numpy.random.random((S.nnz(),1)), numpy.random.random((E.nnz(),1))])
 
+  def test_getnonzeros_fusion(self):
+    x = MX.sym("x",4)
+    X = MX.sym("X",3,3)
+    y = sin(x)
+    Y = sin(X)
+
+    # Concatenations of nonzeros of the same expression
+    self.assertTrue(is_equal(vertcat(y[:2],y[2:]),y))
+    self.assertEqual(n_nodes(vertcat(y[3],y[0],y[1])),n_nodes(y[[3,0,1]]))
+    self.assertEqual(n_nodes(horzcat(Y[:,0],Y[:,2])),n_nodes(Y[:,[0,2]]))
+    self.assertEqual(vertcat(y[0],sin(y[1])).shape,(2,1))
+
+    # Reshapes and transposes do not add copies
+    self.assertEqual(n_nodes(reshape(y[[3,2,1,0]],2,2)),n_nodes(y[[3,2,1,0]]))
+    self.assertEqual(n_nodes(reshape(Y,9,1)[[0,4,8]]),n_nodes(Y[[0,4,8]]))
+    self.assertEqual(n_nodes(Y.T[[1,2]]),n_nodes(Y[[3,6]]))
+
+    np.random.seed(0)
+    for e in [vertcat(y[3],y[0],y[1]),reshape(y[[3,2,1,0]],2,2),Y.T[[1,2]],
+              horzcat(Y[:,0],Y[:,2]),reshape(Y,9,1)[[0,4,8]]]:
+      f = Function('f',[x,X],[e])
+      self.checkfunction(f,f.expand(),inputs=[np.random.random(4),np.random.random((3,3))])
+
+  def test_work_reuse(self):
+    x = MX.sym("x",10)
+    y = sin(x)
+    z = cos(y[:4])
+    v = vertcat(z*z,y[4:6])
+    f = Function('f',[x],[sin(v)])
+    g = Function('g',[x],[sin(v)],{"live_variables":False})
+
+    # The concatenation reuses the larger element freed by y
+    self.assertTrue(f.sz_w()<=16)
+    self.assertTrue(f.sz_w()<g.sz_w())
+    self.checkfunction(f,g,inputs=[np.random.random(10)])
+    self.check_codegen(f,inputs=[np.random.random(10)])
+
+    # Rank1 update whose input stays alive, not evaluated inplace
+    A = MX.sym("A",3,3)
+    a = MX.sym("a",3)
+    f = Function('f',[A,a],[rank1(A,0.5,a,a),A*2])
+    inputs = [np.random.random((3,3)),np.random.random(3)]
+    self.checkfunction(f,f.expand(),inputs=inputs)
+    self.check_codegen(f,inputs=inputs)
+
   def test_evalf(self):
     x = MX.sym("x")
 
@@ -2709,5 +2754,14 @@ class MXtests(casadiTestCase):
   def test_doc_expression_tools(self):
     self.assertTrue("Given a repeated matrix, computes the sum of repeated parts." in repsum.__doc__)
 
+  def test_print_deep(self):
+    x = MX.sym("x")
+    e = x
+    for i in range(100000):
+      e = sin(e)*e
+    s = str(e)
+    self.assertTrue(s.startswith("@1=(sin(x)*x), @2=(sin(@1)*@1), @3=(sin(@2)*@2)"))
+    self.assertTrue(s.endswith(", (sin(@99999)*@99999)"))
+
 if __name__ == '__main__':
     unittest.main()
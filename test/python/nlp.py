@@ -1368,6 +1368,178 @@ class NLPtests(casadiTestCase):
       self.checkarray(solver_out["x"],DM([0]),digits=7)
       if "bonmin" not in str(Solver): self.checkarray(solver_out["lam_x"],DM([0]),digits=7)
 
+  @requires_nlpsol("sqpmethod")
+  @requires_conic("qrqp")
+  def test_sqpmethod_soc(self):
+    # Maratos effect: the full step increases the merit function near the solution
+    x=SX.sym("x",2)
+    nlp={'x':x, 'f':2*(x[0]**2+x[1]**2-1)-x[0], 'g':x[0]**2+x[1]**2-1}
+    opts = {"qpsol": "qrqp", "qpsol_options": {"print_iter":False,"print_header":False},
+            "print_header":False, "print_iteration":False, "print_time":False, "max_iter_ls":10}
+    n_fg = {}
+    for line_search in ["merit", "filter"]:
+      for max_soc in [0, 1]:
+        solver = nlpsol("solver", "sqpmethod", nlp, dict(opts, line_search=line_search, max_soc=max_soc))
+        sol = solver(x0=[cos(0.3),sin(0.3)], lbg=0, ubg=0)
+        stats = solver.stats()
+        self.assertTrue(stats["success"])
+        self.checkarray(sol["x"],DM([1,0]),digits=7)
+        self.assertEqual(stats["n_soc"]>0, max_soc>0)
+        self.assertEqual(stats["n_qp"], stats["iter_count"]+stats["n_soc"])
+        n_fg[(line_search,max_soc)] = stats["n_call_nlp_fg"]
+    self.assertTrue(n_fg[("merit",1)]<n_fg[("merit",0)])
+    self.assertTrue(n_fg[("filter",1)]<n_fg[("merit",0)])
+
+  @requires_nlpsol("sqpmethod")
+  @requires_conic("qrqp")
+  def test_sqpmethod_block_bfgs(self):
+    # Separable objective: the BFGS approximation has one block per pair of variables
+    x=SX.sym("x",20)
+    f = sum([(1-x[i])**2+10*(x[i+1]-x[i]**2)**2 for i in range(0,20,2)])
+    nlp={'x':x, 'f':f, 'g':sum1(x)}
+    sol = {}
+    for hessian_approximation in ["exact", "limited-memory"]:
+      solver = nlpsol("solver", "sqpmethod", nlp, {"qpsol": "qrqp",
+        "qpsol_options": {"print_iter":False,"print_header":False},
+        "hessian_approximation": hessian_approximation, "max_iter_ls": 10,
+        "print_header":False, "print_iteration":False, "print_time":False})
+      sol[hessian_approximation] = solver(x0=0.5, lbg=19, ubg=19)
+      self.assertTrue(solver.stats()["success"])
+    self.checkarray(sol["exact"]["x"],sol["limited-memory"]["x"],digits=5)
+
+  @requires_nlpsol("sqpmethod")
+  @requires_conic("qrqp")
+  def test_sqpmethod_bfgs_first_order(self):
+    # Objective with a Jacobian but no second order derivatives
+    class Jac(Callback):
+      def __init__(self):
+        Callback.__init__(self)
+        self.construct("jac_f", {})
+      def get_n_in(self): return 2
+      def get_sparsity_in(self,i): return Sparsity.dense(3,1) if i==0 else Sparsity.dense(1,1)
+      def get_sparsity_out(self,i): return Sparsity.dense(1,3)
+      def eval(self,arg): return [2*(arg[0]-DM([1,2,3])).T]
+
+    class Fun(Callback):
+      def __init__(self):
+        Callback.__init__(self)
+        self.jac = Jac()
+        self.construct("f", {})
+      def get_sparsity_in(self,i): return Sparsity.dense(3,1)
+      def eval(self,arg): return [sumsqr(arg[0]-DM([1,2,3]))]
+      def has_jacobian(self): return True
+      def get_jacobian(self, name, inames, onames, opts):
+        x = MX.sym("x",3)
+        out_f = MX.sym("out_f")
+        return Function(name, [x,out_f], [self.jac(x,out_f)], inames, onames, opts)
+
+    f = Fun()
+    x = MX.sym("x",3)
+    nlp={'x':x, 'f':f(x), 'g':x[0]+x[1]}
+    solver = nlpsol("solver", "sqpmethod", nlp, {"qpsol": "qrqp",
+      "qpsol_options": {"print_iter":False,"print_header":False},
+      "hessian_approximation": "limited-memory",
+      "print_header":False, "print_iteration":False, "print_time":False})
+    sol = solver(x0=0, lbg=0, ubg=0)
+    self.assertTrue(solver.stats()["success"])
+    self.checkarray(sol["x"], DM([-0.5,0.5,3]), digits=7)
+
+  @requires_nlpsol("sqpmethod")
+  @requires_conic("qrqp")
+  def test_sqpmethod_regularize(self):
+    # Separable and nonconvex: only the first block is indefinite at the initial guess
+    x=SX.sym("x",10)
+    f = sum([(x[i]**2-1)**2+(x[i+1]-x[i])**2 for i in range(0,10,2)])
+    nlp={'x':x, 'f':f, 'g':sum1(x)}
+    solver = nlpsol("solver", "sqpmethod", nlp, {"qpsol": "qrqp",
+      "qpsol_options": {"print_iter":False,"print_header":False}, "regularize": True,
+      "max_iter_ls": 10, "print_header":False, "print_iteration":False, "print_time":False})
+    sol = solver(x0=[0.1,0.3]+[2]*8, lbg=10, ubg=10)
+    self.assertTrue(solver.stats()["success"])
+    grad_f = solver.get_function("nlp_jac_fg")(sol["x"], 0)[1]
+    self.checkarray(grad_f+sol["lam_g"]+sol["lam_x"], DM.zeros(10), digits=7)
+
+  @requires_nlpsol("sqpmethod")
+  @requires_conic("qrqp")
+  def test_sqpmethod_combined_oracle(self):
+    x=SX.sym("x",3)
+    nlp={'x':x, 'f':(x[0]-1)**2+sin(x[1])**2+x[2]**4, 'g':vertcat(x[0]*x[1]-x[2], sumsqr(x))}
+    opts = {"qpsol": "qrqp", "qpsol_options": {"print_iter":False,"print_header":False},
+      "print_header":False, "print_iteration":False, "print_time":False}
+    ref = nlpsol("solver", "sqpmethod", nlp, opts)
+    sol_ref = ref(x0=[1.2,0.6,0.4], lbg=[0,1], ubg=[0,2])
+    opts["combined_oracle"] = True
+    solver = nlpsol("solver", "sqpmethod", nlp, opts)
+    sol = solver(x0=[1.2,0.6,0.4], lbg=[0,1], ubg=[0,2])
+    self.assertTrue(solver.stats()["success"])
+    self.checkarray(sol["x"], sol_ref["x"], digits=8)
+    self.checkarray(sol["lam_g"], sol_ref["lam_g"], digits=8)
+    self.assertEqual(solver.stats()["iter_count"], ref.stats()["iter_count"])
+    self.assertFalse("n_call_nlp_hess_l" in solver.stats())
+    self.assertEqual(solver.stats()["n_call_nlp_sqp"], solver.stats()["iter_count"]+1)
+
+  @requires_nlpsol("sqpmethod")
+  @requires_conic("qrqp")
+  def test_oracle_cache(self):
+    x=SX.sym("x",3)
+    nlp={'x':x, 'f':(x[0]-1)**2+sin(x[1])**2+x[2]**4, 'g':vertcat(x[0]*x[1]-x[2], sumsqr(x))}
+    opts = {"qpsol": "qrqp", "qpsol_options": {"print_iter":False,"print_header":False},
+      "print_header":False, "print_iteration":False, "print_time":False}
+    ref = nlpsol("solver", "sqpmethod", nlp, opts)
+    sol_ref = ref(x0=[1.2,0.6,0.4], lbg=[0,1], ubg=[0,2])
+    opts["cache_size"] = 100
+    solver = nlpsol("solver", "sqpmethod", nlp, opts)
+    sol = solver(x0=[1.2,0.6,0.4], lbg=[0,1], ubg=[0,2])
+    self.checkarray(sol["x"], sol_ref["x"], digits=12)
+    self.assertEqual(solver.stats()["n_call_nlp_jac_fg"], ref.stats()["n_call_nlp_jac_fg"])
+    # Same problem again: served from the cache
+    sol = solver(x0=[1.2,0.6,0.4], lbg=[0,1], ubg=[0,2])
+    stats = solver.stats()
+    self.checkarray(sol["x"], sol_ref["x"], digits=12)
+    self.assertEqual(stats["n_call_nlp_jac_fg"], 0)
+    self.assertEqual(stats["n_cache_hit_nlp_jac_fg"], ref.stats()["n_call_nlp_jac_fg"])
+    self.assertEqual(stats["cache_hit_rate_nlp_jac_fg"], 1)
+
+  def test_nlpsol_batch(self):
+    x=SX.sym("x")
+    p=SX.sym("p")
+    nlp={'x':x, 'p':p, 'f':(x**2-1)**2+p*x}
+
+    for Solver, solver_options in solvers:
+      if "snopt"==Solver: continue
+      if "worhp"==Solver: continue
+      self.message(Solver)
+      solver = nlpsol("mysolver", Solver, nlp, solver_options)
+      x0 = DM([-2,-1.5,-0.5,0.5,1.5,2]).T
+
+      # Multi-start, compare with solving each instance separately
+      batch = nlpsol_batch("batch", solver, 6, {"max_threads": 3})
+      sol = batch(x0=x0, p=0.1)
+      for i in range(6):
+        ref = solver(x0=x0[i], p=0.1)
+        self.checkarray(sol["x"][i], ref["x"], digits=7)
+        self.checkarray(sol["f"][i], ref["f"], digits=7)
+      stats = batch.stats()
+      self.assertEqual(stats["n_solved"], 6)
+      self.assertFalse(stats["target_reached"])
+      self.assertTrue(all(stats["success"]))
+
+      # Scenarios
+      sol = batch(x0=1, p=DM([-0.2,-0.1,0,0.1,0.2,0.3]).T)
+      for i, pi in enumerate([-0.2,-0.1,0,0.1,0.2,0.3]):
+        ref = solver(x0=1, p=pi)
+        self.checkarray(sol["x"][i], ref["x"], digits=7)
+
+      # Stop once the global minimum is found
+      batch = nlpsol_batch("batch", solver, 6, {"max_threads": 1, "f_target": -0.09})
+      sol = batch(x0=x0, p=0.1)
+      stats = batch.stats()
+      self.assertEqual(stats["n_solved"], 1)
+      self.assertTrue(stats["target_reached"])
+      self.checkarray(sol["x"][0], DM([-1.01227]), digits=4)
+      self.assertTrue(all(numpy.isnan(float(e)) for e in sol["x"][1:]))
+      self.assertEqual(stats["return_status"][1], "Not_Solved")
+
 if __name__ == '__main__':
     unittest.main()
     print(solvers)
@@ -834,6 +834,88 @@ class OptiStacktests(inherit_from):
         with self.assertInException("This expression depends on a parameter with unset value"):
           opti.debug.value(q)
 
+    def test_values(self):
+        opti = Opti()
+        x = opti.variable(3)
+        p = opti.parameter()
+        g = sum1(x)>=p
+        opti.subject_to(g)
+        opti.minimize(sumsqr(x))
+        opti.solver(nlpsolver,nlpsolver_options)
+
+        e = sumsqr(x)+p
+        for pv in [3,6]:
+          opti.set_value(p,pv)
+          opti.set_initial(2*x[:2],vertcat(2,4))
+          self.checkarray(opti.debug.value(x,opti.initial()),DM([1,2,0]))
+          sol = opti.solve()
+          # Repeated evaluation of the same expression
+          for i in range(3):
+            self.checkarray(sol.value(e),pv**2/3.0+pv,digits=5)
+          [xv,ev,lv] = sol.values([x,e,opti.dual(g)])
+          self.checkarray(xv,DM.ones(3)*pv/3.0,digits=5)
+          self.checkarray(ev,pv**2/3.0+pv,digits=5)
+          self.checkarray(lv,2*pv/3.0,digits=5)
+          [ev] = opti.debug.values([e],[x==1])
+          self.checkarray(ev,3+pv)
+
+    def test_rebake(self):
+        opti = Opti()
+        x = opti.variable(3)
+        p = opti.parameter()
+        opti.minimize(sumsqr(x-p))
+        g1 = sum1(x)<=1
+        g2 = x[0]>=0.5
+        opti.solver(nlpsolver,nlpsolver_options)
+        opti.set_value(p,1)
+
+        # Toggle a constraint between solves
+        for k in range(4):
+          opti.subject_to()
+          opti.subject_to(g1)
+          if k % 2: opti.subject_to(g2)
+          sol = opti.solve()
+          self.checkarray(sol.value(x),DM([0.5,0.25,0.25]) if k % 2 else DM.ones(3)/3,digits=5)
+          stats = sol.stats()
+          self.assertEqual(stats["n_call_bake"],k+1)
+          self.assertEqual(stats["n_call_construct"],min(k+1,2))
+          self.assertEqual(stats["n_reuse_construct"],max(k-1,0))
+
+    def test_to_function(self):
+        opti = Opti()
+        x = opti.variable(3)
+        y = opti.variable()
+        p = opti.parameter()
+        q = opti.parameter()
+        opti.minimize(sumsqr(x-p)+(y-q)**2)
+        g = sum1(x)<=1
+        opti.subject_to(g)
+        opti.subject_to(y>=p)
+        opti.solver(nlpsolver,nlpsolver_options)
+        opti.set_value(q,2)
+
+        F = opti.to_function("F",[p,x],[x,y,opti.dual(g)],["p","x0"],["x","y","lam"])
+        [xv,yv,lv] = F(1,DM.zeros(3))
+        self.checkarray(xv,DM.ones(3)/3,digits=5)
+        self.checkarray(yv,2,digits=5)
+        self.checkarray(lv,4.0/3,digits=5)
+
+        # Warm start from the previous solution
+        [xv,yv,lv] = F(3,xv)
+        self.checkarray(yv,3,digits=5)
+        self.checkarray(lv,16.0/3,digits=5)
+
+        # Consistent with solve
+        opti.set_value(p,3)
+        sol = opti.solve()
+        self.checkarray(sol.value(y),yv,digits=5)
+
+        G = opti.to_function("G",[q],[y])
+        self.checkarray(G(5),5,digits=5)
+
+        with self.assertInException("not purely symbolic"):
+          opti.to_function("H",[2*p],[y])
+
     def test_introspection(self):
       opti = Opti()
       x = opti.variable()
@@ -547,5 +547,62 @@ class Sparsitytests(casadiTestCase):
     self.checkarray(A,B)
     self.assertFalse(np.any(D[[e for e,k in zip(z,zres) if k==-1]]))    
 
+  def test_cache_stats(self):
+    s0 = Sparsity.cache_stats()
+    a = Sparsity.lower(17)
+    s1 = Sparsity.cache_stats()
+    b = Sparsity.lower(17)
+    s2 = Sparsity.cache_stats()
+    self.assertTrue(a.is_equal(b))
+    self.assertEqual(s2["n_hit"], s1["n_hit"]+1)
+    self.assertEqual(s2["n_miss"], s1["n_miss"])
+    self.assertTrue(s1["n_miss"]>s0["n_miss"])
+
+    # Entries of deleted patterns are eventually removed
+    for i in range(2000):
+      Sparsity.banded(i+20, 2)
+    s3 = Sparsity.cache_stats()
+    self.assertTrue(s3["n_sweep"]>s2["n_sweep"])
+    self.assertTrue(s3["size"]<2000)
+    self.assertTrue(s3["n_alive"]<=s3["size"])
+
+  def test_stages(self):
+    N = 10
+    nx = 3
+    nu = 2
+    # Variables [x0, u0, x1, u1, ..., xN], x_{k+1} depends on x_k and u_k
+    nv = N*(nx+nu)+nx
+    H = Sparsity.diag(nv)
+    J = []
+    for k in range(N):
+      o = k*(nx+nu)
+      J.append(horzcat(Sparsity(nx, o), Sparsity.dense(nx, nx+nu), Sparsity.diag(nx), Sparsity(nx, nv-o-2*nx-nu)))
+    J = vertcat(*J)
+
+    random.seed(1)
+    p = list(range(nv))
+    q = list(range(J.size1()))
+    random.shuffle(p)
+    random.shuffle(q)
+    H = DM.ones(H)[p, p].sparsity()
+    J = DM.ones(J)[q, p].sparsity()
+
+    nb, xperm, xoff, gperm, goff = Sparsity.stages(H, J)
+    self.assertEqual(nb, N+1)
+    self.assertEqual(sorted(xperm), list(range(nv)))
+    self.assertEqual(sorted(gperm), list(range(J.size1())))
+
+    # Block tridiagonal KKT system
+    xstage = [0]*nv
+    gstage = [0]*J.size1()
+    for b in range(nb):
+      for k in range(xoff[b], xoff[b+1]): xstage[xperm[k]] = b
+      for k in range(goff[b], goff[b+1]): gstage[gperm[k]] = b
+      self.assertTrue(xoff[b+1]-xoff[b]<=nx+nu+nx)
+    for r, c in zip(*H.get_triplet()):
+      self.assertTrue(abs(xstage[r]-xstage[c])<=1)
+    for r, c in zip(*J.get_triplet()):
+      self.assertTrue(xstage[c]-gstage[r] in [0, 1])
+
 if __name__ == '__main__':
     unittest.main()
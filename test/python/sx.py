@@ -1419,6 +1419,38 @@ class SXtests(casadiTestCase):
     with self.assertInException("since variables [x] are free"):
       evalf(x)
 
+  def test_print_deep(self):
+    x = SX.sym("x")
+    e = x
+    for i in range(100000):
+      e = sin(e)*e
+    s = str(e)
+    self.assertTrue(s.startswith("@1=(sin(x)*x), @2=(sin(@1)*@1), @3=(sin(@2)*@2)"))
+    self.assertTrue(s.endswith(", (sin(@99999)*@99999)"))
+
+  def test_substitute_shared(self):
+    x = SX.sym("x")
+    y = SX.sym("y")
+    z = SX.sym("z")
+    e = x
+    for i in range(10000):
+      e = sin(e)*y + e
+    c = cos(z)*x
+    r = substitute([e, c, z*y], [x, y], [y+1, 2*z])
+    f = Function('f', [x, y, z], [e, c, z*y])
+    g = Function('g', [x, y, z], r)
+    for a, b in zip(f(1.3, 1.4, 0.7), g(0.1, 0.3, 0.7)):
+      self.checkarray(a, b)
+
+    # Unaffected subexpressions are kept
+    r = substitute([c, e], [y], [z])
+    self.assertTrue(is_equal(r[0], c))
+
+    with self.assertRaises(Exception):
+      substitute(e, 2*x, y)
+    with self.assertRaises(Exception):
+      substitute(e, vertcat(x, x), vertcat(y, z))
+
 
 if __name__ == '__main__':
     unittest.main()